@@ -9,11 +9,21 @@
 #include <GLFW/glfw3.h>
 
 #include <iostream>
+#include <cmath>
+
+#include "GLExtensions.h"
+#include "ShaderSource.h"
+#include "ProgramPipeline.h"
+#include "GeometryCache.h"
+#include "GeometryArena.h"
+#include "VertexLayout.h"
+#include "RenderQueue.h"
+#include "StreamBuffer.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
 
-const char *vertexShaderSource = "#version 330 core\n"
+constexpr ShaderSource vertexShaderSource = "#version 330 core\n"
     "layout (location = 0) in vec3 aPos;\n"
     "layout (location = 1) in vec3 inColor;\n"
     "out vec3 outColor;\n"
@@ -21,30 +31,33 @@ const char *vertexShaderSource = "#version 330 core\n"
     "{\n"
     "   gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);\n"
     "   outColor = inColor;\n"
-    "}\0";
+    "}\n";
 
-const char *fragmentShaderSource = "#version 330 core\n"
+constexpr ShaderSource fragmentShaderSource = "#version 330 core\n"
     "in vec3 outColor;\n"
     "out vec4 FragColor;\n"
     "void main()\n"
     "{\n"
     "   FragColor = vec4(outColor, 1.0);\n"
-    "}\0";
+    "}\n";
 
-const char *fixedFragmentShaderSource = "#version 330 core\n"
+constexpr ShaderSource fixedFragmentShaderSource = "#version 330 core\n"
     "out vec4 FragColor;\n"
     "void main()\n"
     "{\n"
     "   FragColor = vec4(1.0, 1.0, 0.0, 1.0);\n"
-    "}\0";
+    "}\n";
 
-const char *timeChangingFragmentShaderSource = "#version 330 core\n"
+constexpr ShaderSource timeChangingFragmentShaderSource = "#version 330 core\n"
     "out vec4 FragColor;\n"
     "uniform vec4 ourColor;\n"
     "void main()\n"
     "{\n"
     "   FragColor = ourColor;\n"
-    "}\0";
+    "}\n";
+
+constexpr VertexLayout POSITION = { { 0, VertexFormat::FLOAT3 } };
+constexpr VertexLayout POSITION_COLOR = { { 0, VertexFormat::FLOAT3 }, { 1, VertexFormat::FLOAT3 } };
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -54,6 +67,12 @@ void drawPureTriangle();
 void drawGradientTriangle();
 void drawTwoTriangle();
 void drawTwoTriangleWith2Program();
+void drawStreamedTriangles(float radius, float speed);
+static GeometryCache& geometryCache();
+static GeometryArena& geometryArena();
+static ProgramPipelines& programCache();
+static RenderQueue& renderQueue();
+static StreamBuffer& streamBuffer();
 
 int triangl1()
 {
@@ -87,6 +106,7 @@ int triangl1()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    glext().load((GLADloadproc)glfwGetProcAddress);
 
     // render loop
     // -----------
@@ -101,7 +121,15 @@ int triangl1()
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
+        streamBuffer().begin();
+
         drawTwoTriangleWith2Program();
+        // two producers sharing this frame's stream, each writes, commits and draws
+        drawStreamedTriangles(0.8f, 1.0f);
+        drawStreamedTriangles(0.5f, -1.5f);
+
+        // fences this frame's part of the stream buffer
+        streamBuffer().end();
         
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -109,6 +137,26 @@ int triangl1()
         glfwPollEvents();
     }
 
+    // after the first frame these stay flat, later frames create nothing
+    const GeometryCache::Stats& geometry = geometryCache().stats();
+    const ProgramPipelines::Stats& programs = programCache().stats();
+    std::cout << "GEOMETRY_CACHE: vertexArrays=" << geometry.vertexArrays << " buffers=" << geometry.buffers
+              << " hits=" << geometry.hits << " misses=" << geometry.misses << std::endl;
+    GeometryArena::Stats arena = geometryArena().stats();
+    std::cout << "GEOMETRY_ARENA: meshes=" << arena.meshes << " vertexBytes=" << arena.vertexBytes
+              << " capacityBytes=" << arena.capacityBytes << " grows=" << arena.grows << std::endl;
+    std::cout << "PROGRAM_CACHE: stages=" << programs.stages << " links=" << programs.links
+              << " pipelines=" << programs.pipelines << " reused=" << programs.reused << std::endl;
+    const RenderQueue::Stats& queue = renderQueue().stats();
+    std::cout << "RENDER_QUEUE: items=" << queue.items << " programs=" << queue.programs
+              << " vertexArrays=" << queue.vertexArrays << " stateChanges=" << queue.sorted()
+              << " unsortedStateChanges=" << queue.unsorted() << " saved=" << queue.saved() << std::endl;
+
+    const StreamBuffer::Stats& stream = streamBuffer().stats();
+    std::cout << "STREAM_BUFFER: persistent=" << streamBuffer().persistent() << " frames=" << stream.frames
+              << " bytes=" << stream.bytes << " stalls=" << stream.stalls << " overflows=" << stream.overflows << std::endl;
+    streamBuffer().release();
+
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
     glfwTerminate();
@@ -132,6 +180,41 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     glViewport(0, 0, width, height);
 }
 
+// created on the first draw and reused by every later frame
+// ---------------------------------------------------------------------------------------------------------
+static GeometryCache& geometryCache()
+{
+    static GeometryCache cache;
+    return cache;
+}
+
+// every POSITION_COLOR mesh in one buffer behind one VAO
+static GeometryArena& geometryArena()
+{
+    static GeometryArena arena(POSITION_COLOR, GL_UNSIGNED_SHORT, 1024, 1024);
+    return arena;
+}
+
+static ProgramPipelines& programCache()
+{
+    static ProgramPipelines pipelines;
+    return pipelines;
+}
+
+// per-frame vertices, enough for a few thousand POSITION_COLOR vertices
+static StreamBuffer& streamBuffer()
+{
+    static StreamBuffer stream(64 * 1024);
+    return stream;
+}
+
+// items carry pipeline objects, not programs
+static RenderQueue& renderQueue()
+{
+    static RenderQueue queue(&ProgramPipelines::use);
+    return queue;
+}
+
 void drawPureTriangle()
 {
     // draw triangle
@@ -141,67 +224,16 @@ void drawPureTriangle()
          0.0f,  0.5f, 0.0f
     };
     
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    
-    glBindVertexArray(VAO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    unsigned int VAO = geometryCache().vertexArray(vertices, sizeof(vertices), POSITION);
     
-    // read vertex
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // unbind VBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    
-    // unbind VAO
-    glBindVertexArray(0);
-    
-    // create vertices shader
-    unsigned int vertexShader;
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    
-    int  success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-
-    if(!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-    
-    // color shader
-    unsigned int fragmentShader;
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    
-    // program
-    unsigned int shaderProgram;
-    shaderProgram = glCreateProgram();
-    
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+    ShaderStage& vertexShader = programCache().stage(GL_VERTEX_SHADER, vertexShaderSource);
+    ShaderStage& fragmentShader = programCache().stage(GL_FRAGMENT_SHADER, fragmentShaderSource);
     
     // use this program
-    glUseProgram(shaderProgram);
-    glBindVertexArray(VAO);
+    programCache().bind(vertexShader, fragmentShader);
+    glstate().bindVertexArray(VAO);
     // draw
     glDrawArrays(GL_TRIANGLES, 0, 3);
-    
-    // delete shader
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
 }
 
 void drawGradientTriangle()
@@ -213,69 +245,16 @@ void drawGradientTriangle()
          0.0f,  0.5f, 0.0f, 0.f, 0.f, 1.f,
     };
     
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    
-    glBindVertexArray(VAO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    // read vertex
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    
-    // unbind VBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    
-    // unbind VAO
-    glBindVertexArray(0);
-    
-    // create vertices shader
-    unsigned int vertexShader;
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    
-    int  success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-
-    if(!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-    
-    // color shader
-    unsigned int fragmentShader;
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
+    unsigned int VAO = geometryCache().vertexArray(vertices, sizeof(vertices), POSITION_COLOR);
     
-    // program
-    unsigned int shaderProgram;
-    shaderProgram = glCreateProgram();
-    
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+    ShaderStage& vertexShader = programCache().stage(GL_VERTEX_SHADER, vertexShaderSource);
+    ShaderStage& fragmentShader = programCache().stage(GL_FRAGMENT_SHADER, fragmentShaderSource);
     
     // use this program
-    glUseProgram(shaderProgram);
-    glBindVertexArray(VAO);
+    programCache().bind(vertexShader, fragmentShader);
+    glstate().bindVertexArray(VAO);
     // draw
     glDrawArrays(GL_TRIANGLES, 0, 3);
-    
-    // delete shader
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
 }
 
 void drawTwoTriangle()
@@ -290,69 +269,16 @@ void drawTwoTriangle()
         0.25f,  0.5f, 0.0f, 0.f, 0.f, 1.f,
     };
     
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    
-    glBindVertexArray(VAO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    // read vertex
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    
-    // unbind VBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    unsigned int VAO = geometryCache().vertexArray(vertices, sizeof(vertices), POSITION_COLOR);
     
-    // unbind VAO
-    glBindVertexArray(0);
-    
-    // create vertices shader
-    unsigned int vertexShader;
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    
-    int  success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-
-    if(!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-    
-    // color shader
-    unsigned int fragmentShader;
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    
-    // program
-    unsigned int shaderProgram;
-    shaderProgram = glCreateProgram();
-    
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+    ShaderStage& vertexShader = programCache().stage(GL_VERTEX_SHADER, vertexShaderSource);
+    ShaderStage& fragmentShader = programCache().stage(GL_FRAGMENT_SHADER, fragmentShaderSource);
     
     // use this program
-    glUseProgram(shaderProgram);
-    glBindVertexArray(VAO);
+    programCache().bind(vertexShader, fragmentShader);
+    glstate().bindVertexArray(VAO);
     // draw
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    
-    // delete shader
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
 }
 
 void drawTwoTriangleWith2Program()
@@ -370,106 +296,77 @@ void drawTwoTriangleWith2Program()
         0.25f,  0.5f, 0.0f, 0.f, 0.f, 1.f,
     };
     
-    unsigned int VBO[2];
-    glGenBuffers(2, VBO);
-    
-    unsigned int VAO[2];
-    glGenVertexArrays(2, VAO);
-    
-    glBindVertexArray(VAO[0]);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    // read vertex
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    
-    // unbind VBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    
-    // unbind VAO
-    glBindVertexArray(0);
-    
-    // -------------- next VAO & VBO ---------------
-    
-    glBindVertexArray(VAO[1]);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices2, GL_STATIC_DRAW);
+    // both triangles go into the arena on the first frame and share its VAO
+    static const unsigned int triangles[2] = {
+        geometryArena().add(vertices, 3),
+        geometryArena().add(vertices2, 3),
+    };
     
-    // read vertex
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
+    // both programs share the vertex stage
+    ShaderStage& vertexShader = programCache().stage(GL_VERTEX_SHADER, vertexShaderSource);
+    ShaderStage& fragmentShader = programCache().stage(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    ShaderStage& fragmentShader2 = programCache().stage(GL_FRAGMENT_SHADER, fixedFragmentShaderSource);
     
-    // unbind VBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // the queue orders the draws by program and VAO and skips repeated binds
+    DrawItem item = geometryArena().drawItem(triangles[0]);
+    item.program = programCache().object(vertexShader, fragmentShader);
+    renderQueue().push(item);
     
-    // unbind VAO
-    glBindVertexArray(0);
+    // next
+    item = geometryArena().drawItem(triangles[1]);
+    item.program = programCache().object(vertexShader, fragmentShader2);
+    renderQueue().push(item);
     
-    // create vertices shader
-    unsigned int vertexShader;
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    renderQueue().flush();
+}
 
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    
-    int  success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+void drawStreamedTriangles(float radius, float speed)
+{
+    const unsigned int COUNT = 12;
+    const unsigned int stride = POSITION_COLOR.stride();
 
-    if(!success)
+    // one VAO reading the stream buffer, draws pick their vertices with first
+    static unsigned int VAO = 0;
+    if (!VAO)
     {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+        glGenVertexArrays(1, &VAO);
+        glstate().bindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, streamBuffer().ID);
+        POSITION_COLOR.apply();
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glstate().bindVertexArray(0);
     }
-    
-    // color shader
-    unsigned int fragmentShader;
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    
-    
-    unsigned int fragmentShader2;
-    fragmentShader2 = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader2, 1, &fixedFragmentShaderSource, NULL);
-    glCompileShader(fragmentShader2);
-    
-    // program
-    unsigned int shaderProgram;
-    shaderProgram = glCreateProgram();
-    
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    
-    // program
-    unsigned int shaderProgram2;
-    shaderProgram2 = glCreateProgram();
-    
-    glAttachShader(shaderProgram2, vertexShader);
-    glAttachShader(shaderProgram2, fragmentShader2);
-    glLinkProgram(shaderProgram2);
-    
+
+    // a ring of small triangles that moves every frame, built on the CPU
+    StreamBuffer::Allocation triangles = streamBuffer().allocate(COUNT * 3 * stride, stride);
+    if (!triangles.data)
+        return;
+    // write-combined memory: fill it front to back and never read it back
+    float* vertex = (float*)triangles.data;
+    float time = (float)glfwGetTime() * speed;
+    for (unsigned int i = 0; i < COUNT; i++)
+    {
+        float angle = time + i * 6.2831853f / COUNT;
+        float x = radius * cosf(angle), y = radius * sinf(angle);
+        for (unsigned int corner = 0; corner < 3; corner++)
+        {
+            float spin = angle * 2.0f + corner * 2.0943951f;
+            *vertex++ = x + 0.05f * cosf(spin);
+            *vertex++ = y + 0.05f * sinf(spin);
+            *vertex++ = 0.0f;
+            *vertex++ = corner == 0 ? 1.f : 0.f;
+            *vertex++ = corner == 1 ? 1.f : 0.f;
+            *vertex++ = corner == 2 ? 1.f : 0.f;
+        }
+    }
+    streamBuffer().commit();
+
+    ShaderStage& vertexShader = programCache().stage(GL_VERTEX_SHADER, vertexShaderSource);
+    ShaderStage& fragmentShader = programCache().stage(GL_FRAGMENT_SHADER, fragmentShaderSource);
+
     // use this program
-    glUseProgram(shaderProgram);
-    glBindVertexArray(VAO[0]);
+    programCache().bind(vertexShader, fragmentShader);
+    glstate().bindVertexArray(VAO);
     // draw
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-    
-    glUseProgram(shaderProgram2);
-    // next
-    glBindVertexArray(VAO[1]);
-    // draw
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-    
-    // delete shader
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    glDrawArrays(GL_TRIANGLES, (GLint)(triangles.offset / stride), COUNT * 3);
 }
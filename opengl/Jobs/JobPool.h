@@ -0,0 +1,231 @@
+//
+//  JobPool.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef JobPool_h
+#define JobPool_h
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+// work-stealing pool for per-object frame work. every thread owns a deque
+// and parallelFor deals each one a contiguous share of the pieces. owners pop
+// at the back, a thread that runs dry steals from the front of the others.
+// the thread that calls parallelFor owns deque 0 and works through its share
+// too until the whole batch is finished, so a pool of N workers uses N + 1
+// cores and JobPool(0) runs everything inline.
+//
+//   JobPool jobs;
+//   jobs.parallelFor(count, 4096, [&](size_t begin, size_t end) { ... });
+//
+// jobs must not call parallelFor themselves. no GL calls inside jobs either,
+// the context belongs to the render thread.
+class JobPool
+{
+public:
+    struct Stats
+    {
+        std::atomic<unsigned long long> jobs{ 0 };
+        std::atomic<unsigned long long> steals{ 0 };  // jobs run by a thread that did not queue them
+
+        void reset()
+        {
+            jobs = 0;
+            steals = 0;
+        }
+    };
+
+    // workers besides the calling thread
+    explicit JobPool(unsigned int workers = defaultWorkers())
+        : stopping(false), queued(0)
+    {
+        for (unsigned int i = 0; i <= workers; i++)
+            queues.push_back(std::unique_ptr<Queue>(new Queue()));
+        for (unsigned int i = 1; i <= workers; i++)
+            threads.push_back(std::thread(&JobPool::work, this, i));
+    }
+    ~JobPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    // hardware threads minus the one that calls parallelFor
+    static unsigned int defaultWorkers()
+    {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 0;
+    }
+    unsigned int threadCount() const
+    {
+        return (unsigned int)queues.size();
+    }
+    Stats& stats()
+    {
+        return stat;
+    }
+    // body(begin, end) over [0, count) in pieces [k * grain, (k + 1) * grain),
+    // the last one shorter. returns once every piece has run
+    // ------------------------------------------------------------------------
+    template <typename Body>
+    void parallelFor(size_t count, size_t grain, const Body& body)
+    {
+        grain = grain ? grain : 1;
+        size_t pieces = (count + grain - 1) / grain;
+        if (threads.empty() || pieces < 2)
+        {
+            for (size_t begin = 0; begin < count; begin += grain)
+                body(begin, begin + grain < count ? begin + grain : count);
+            stat.jobs += pieces;
+            return;
+        }
+
+        // each thread starts on its own contiguous share, stealing evens out
+        // whatever turns out slower
+        std::atomic<size_t> pending(pieces);
+        // counted first so a worker that grabs a job early never sees it negative
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queued += pieces;
+        }
+        unsigned int shares = threadCount();
+        for (unsigned int t = 0; t < shares; t++)
+        {
+            Queue& queue = *queues[t];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            for (size_t piece = pieces * t / shares; piece < pieces * (t + 1) / shares; piece++)
+            {
+                Job job;
+                job.run = &invoke<Body>;
+                job.body = &body;
+                job.begin = piece * grain;
+                job.end = job.begin + grain < count ? job.begin + grain : count;
+                job.owner = t;
+                job.pending = &pending;
+                queue.jobs.push_back(job);
+            }
+        }
+        wake.notify_all();
+
+        // help until the batch is done, the last pieces may be running elsewhere
+        while (pending.load(std::memory_order_acquire) != 0)
+        {
+            if (!runOne(0))
+                std::this_thread::yield();
+        }
+    }
+
+private:
+    struct Job
+    {
+        void (*run)(const void* body, size_t begin, size_t end);
+        const void* body;
+        size_t begin;
+        size_t end;
+        unsigned int owner;
+        std::atomic<size_t>* pending;
+    };
+    // padded so two threads' locks never share a cache line
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        char padding[64];
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping;
+    size_t queued;  // jobs in all deques, guarded by sleepMutex
+    Stats stat;
+
+    // ------------------------------------------------------------------------
+    template <typename Body>
+    static void invoke(const void* body, size_t begin, size_t end)
+    {
+        (*(const Body*)body)(begin, end);
+    }
+    // ------------------------------------------------------------------------
+    void work(unsigned int self)
+    {
+        for (;;)
+        {
+            if (runOne(self))
+                continue;
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping)
+                return;
+        }
+    }
+    // own newest job, or the oldest one of another thread. false when every
+    // deque was empty
+    // ------------------------------------------------------------------------
+    bool runOne(unsigned int self)
+    {
+        Job job = Job();
+        if (!pop(self, job))
+        {
+            unsigned int count = (unsigned int)queues.size();
+            unsigned int victim = 1;
+            for (; victim < count; victim++)
+            {
+                if (steal((self + victim) % count, job))
+                    break;
+            }
+            if (victim == count)
+                return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queued--;
+        }
+
+        job.run(job.body, job.begin, job.end);
+        stat.jobs++;
+        if (job.owner != self)
+            stat.steals++;
+        job.pending->fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    bool pop(unsigned int index, Job& job)
+    {
+        Queue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+            return false;
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+        return true;
+    }
+    bool steal(unsigned int index, Job& job)
+    {
+        Queue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+            return false;
+        job = queue.jobs.front();
+        queue.jobs.pop_front();
+        return true;
+    }
+};
+
+#endif /* JobPool_h */
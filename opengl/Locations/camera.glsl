@@ -0,0 +1,6 @@
+// view and projection from CameraBuffer, the layout has to match its upload
+layout (std140) uniform Camera
+{
+    mat4 view;
+    mat4 projection;
+};
@@ -12,13 +12,96 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
 #include "Shader.h"
+#include "Uniform.h"
+#include "CameraBuffer.h"
+#include "ShaderWatcher.h"
+#include "ShaderVariants.h"
+#include "InstanceBuffer.h"
+#include "IndirectBatch.h"
+#include "MeshOptimizer.h"
+#include "VertexLayout.h"
+#include "MeshFile.h"
+#include "TransformBatch.h"
+#include "TransformHierarchy.h"
+#include "Frustum.h"
+#include "JobPool.h"
+#include "EntityStore.h"
 #include "stb_image.h"
 
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// the cube as written below, and as uploaded: 20 -> 12 bytes per vertex
+constexpr VertexLayout CUBE_SOURCE = { { 0, VertexFormat::FLOAT3 }, { 2, VertexFormat::FLOAT2 } };
+constexpr VertexLayout CUBE_PACKED = { { 0, VertexFormat::HALF4 }, { 2, VertexFormat::UNORM16_2 } };
+
+// bounding sphere of the unit cube around its center, whatever the rotation
+const float CUBE_RADIUS = 0.8660254f;
+
+// EntityStore::mesh / material values, the cube is all this scene has
+const unsigned short CUBE_MESH = 0;
+const unsigned short CONTAINER_MATERIAL = 0;
+
+// what a cube draw needs, whether it came from cube.mesh or the vertices below
+struct CubeGeometry
+{
+    unsigned int VAO;
+    GLsizei indexCount;
+    GLenum indexType;
+};
+
+// per-frame CPU results of the instanced path
+struct CubeFrame
+{
+    std::vector<glm::mat4> models;       // every cube, model or projection * view * model
+    std::vector<unsigned char> inside;   // passed the frustum test
+    std::vector<size_t> chunkOffsets;    // where each chunk's visible cubes start
+    std::vector<glm::mat4> visible;      // visibleCount of these are uploaded
+    size_t visibleCount = 0;
+};
+
+// the cube programs, each with a variant that reads one premultiplied matrix
+struct CubePrograms
+{
+    Shader& perDraw;
+    Shader& instanced;
+    Shader& perDrawMvp;
+    Shader& instancedMvp;
+    Uniform<glm::mat4>& model;
+    Uniform<glm::mat4>& mvp;
+};
+
+// uniform names, hashed at compile time
+constexpr UniformName OUR_TEXTURE = "ourTexture";
+constexpr UniformName MODEL = "model";
+constexpr UniformName MVP = "mvp";
+
 void framebuffer_size_callback5(GLFWwindow* window, int width, int height);
+void fillCubeField(std::vector<glm::vec3>& positions, size_t count);
+void buildCubeTransforms(const std::vector<glm::vec3>& positions, TransformSoA& transforms);
+void buildCubeScene(const std::vector<glm::vec3>& positions, EntityStore& scene);
+unsigned int createCube(EntityStore& scene, const glm::vec3& position, float spin);
+void spinEntities(EntityStore& scene, float deltaTime);
+void updateCubeModels(const TransformSoA& transforms, std::vector<glm::mat4>& models, float time);
+void updateCubeMvps(const TransformSoA& transforms, const glm::mat4& viewProjection, std::vector<glm::mat4>& mvps, float time);
+void updateCubeModelsGlm(const std::vector<glm::vec3>& positions, std::vector<glm::mat4>& models, float time);
+void runTransformBenchmark();
+void updateVisibleCubes(JobPool& jobs, const TransformSoA& transforms, const Frustum& frustum, const float* viewProjection,
+                        float time, CubeFrame& frame);
+void runJobScalingBenchmark(size_t cubes);
+void runHierarchyBenchmark(size_t cubes);
+void runEntityBenchmark(size_t entities);
+void runCubeBenchmark(GLFWwindow* window, size_t maxCubes, const CubeGeometry& cube, CubePrograms& programs,
+                      InstanceBuffer& instances, const glm::mat4& viewProjection);
 
 void processInput5(GLFWwindow *window)
 {
@@ -26,8 +109,59 @@ void processInput5(GLFWwindow *window)
         glfwSetWindowShouldClose(window, true);
 }
 
-int main()
+// location [--mvp | --benchmark [maxCubes] | --transform-benchmark | --jobs-benchmark [cubes] |
+//           --hierarchy-benchmark [cubes] | --entity-benchmark [entities]]
+// the benchmark draws 10 up to maxCubes (default 1M) cubes one draw each,
+// as one multi-draw-indirect and instanced, the one-per-cube and instanced
+// paths once more with projection * view * model multiplied on the CPU,
+// prints the frame times and exits. its window stays hidden, so it also runs
+// headless on llvmpipe:
+//
+//   xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ./location --benchmark 100000
+//
+// the transform benchmark times the model matrices alone, the jobs benchmark
+// the whole per-frame CPU update on 1 to N threads, the hierarchy benchmark
+// world matrix updates when only part of a scene graph moved, the entity
+// benchmark the per-frame systems over an EntityStore. none of them needs a
+// window.
+// --mvp draws the scene with the premultiplied matrices.
+int main(int argc, char** argv)
 {
+    bool benchmark = argc > 1 && strcmp(argv[1], "--benchmark") == 0;
+    bool premultiplied = argc > 1 && strcmp(argv[1], "--mvp") == 0;
+    size_t maxCubes = 1000000;
+    if (argc > 2)
+    {
+        // every path sizes its arrays from the count, 0 would leave them empty
+        char* end = NULL;
+        maxCubes = strtoul(argv[2], &end, 10);
+        if (argv[2][0] == '-' || end == argv[2] || *end != '\0' || maxCubes == 0)
+        {
+            std::cout << "Invalid cube count " << argv[2] << ", expected a number above 0" << std::endl;
+            return -1;
+        }
+    }
+    if (argc > 1 && strcmp(argv[1], "--transform-benchmark") == 0)
+    {
+        runTransformBenchmark();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--jobs-benchmark") == 0)
+    {
+        runJobScalingBenchmark(maxCubes);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--hierarchy-benchmark") == 0)
+    {
+        runHierarchyBenchmark(maxCubes);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--entity-benchmark") == 0)
+    {
+        runEntityBenchmark(maxCubes);
+        return 0;
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -36,6 +170,8 @@ int main()
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    if (benchmark)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     // glfw window creation
     // --------------------
@@ -56,6 +192,7 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    glext().load((GLADloadproc)glfwGetProcAddress);
     
     stbi_set_flip_vertically_on_load(true);
     
@@ -67,8 +204,7 @@ int main()
     unsigned int texture1;
     glGenTextures(1, &texture1);
     
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture1);
+    glstate().bindTexture(0, GL_TEXTURE_2D, texture1);
     
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data1);
     glGenerateMipmap(GL_TEXTURE_2D);
@@ -120,11 +256,6 @@ int main()
         -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
     };
     
-    unsigned int indices[] = {
-        0, 1, 3, // first triangle
-        1, 2, 3  // second triangle
-    };
-    
     unsigned int VBO;
     glGenBuffers(1, &VBO);
     
@@ -133,35 +264,103 @@ int main()
     
     unsigned int EBO;
     glGenBuffers(1, &EBO);
-    
-    glBindVertexArray(VAO);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    
-    // read vertex
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    
-    // unbind VBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    
-    // unbind VAO
-    glBindVertexArray(0);
 
-    // shader
-    Shader ourShader("shader4.vs", "shader4.fs");
+    // cube.mesh is cube.obj through Tools/meshconv: mapped, and its blobs
+    // handed to the driver as they are. without it the vertices above are
+    // welded, indexed and packed here
+    CubeGeometry cube = { VAO, 0, GL_UNSIGNED_SHORT };
+    MeshFile cubeFile;
+    if (cubeFile.open("cube.mesh"))
+    {
+        cubeFile.upload(VAO, VBO, EBO);
+        cube.indexCount = (GLsizei)cubeFile.header().indexCount;
+        cube.indexType = cubeFile.header().indexType;
+        std::cout << "MESH cube.mesh: vertices " << cubeFile.header().vertexCount << ", stride " << cubeFile.layout().stride() << std::endl;
+    }
+    else
+    {
+        MeshOptimizer::Report report;
+        IndexedMesh mesh = MeshOptimizer::optimize(vertices, 36, CUBE_SOURCE.stride() / sizeof(float), &report);
+        std::cout << "MESH cube: vertices " << report.inputVertices << " -> " << report.outputVertices
+                  << ", ACMR " << report.acmrBefore << " -> " << report.acmrAfter << std::endl;
+        cube.indexCount = (GLsizei)mesh.indices.size();
+        cube.indexType = mesh.indexType();
+
+        glstate().bindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        std::vector<unsigned char> packed;
+        CUBE_PACKED.pack(mesh.vertices.data(), mesh.vertexCount(), CUBE_SOURCE, packed);
+        glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indexDataSize(), mesh.indexData(), GL_STATIC_DRAW);
+
+        // read vertex
+        CUBE_PACKED.apply();
+
+        // unbind VBO
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // unbind VAO
+        glstate().bindVertexArray(0);
+    }
+
+    // view and projection live in one uniform buffer shared by every program
+    CameraBuffer camera;
+
+    // shader, linked programs are cached on disk between launches. the
+    // variants expand #include "camera.glsl". all four are requested before
+    // any is finished, so their compiles overlap. the instanced ones read the
+    // model matrix per instance, the whole field is one draw; the
+    // PREMULTIPLIED_MVP ones read projection * view * model as one matrix, the
+    // vertex stage does one mat4 * vec4 instead of two mat4 * mat4 on top
+    ProgramBinaryCache shaderCache("shader_cache");
+    ShaderVariants variants(&shaderCache);
+    Shader& ourShader = variants.request("shader4.vs", "shader4.fs");
+    Shader& instancedShader = variants.request("shader4_instanced.vs", "shader4.fs");
+    Shader& mvpShader = variants.request("shader4.vs", "shader4.fs", { "PREMULTIPLIED_MVP" });
+    Shader& instancedMvpShader = variants.request("shader4_instanced.vs", "shader4.fs", { "PREMULTIPLIED_MVP" });
+    variants.finish();
+    shaderCache.printStats();
+
+    // edits to shader4.vs/.fs are picked up without restarting. the watcher
+    // would rebuild the MVP variants without the define, they are not watched
+    ShaderWatcher shaderWatcher;
+    shaderWatcher.watch(ourShader, "shader4.vs", "shader4.fs");
+    shaderWatcher.watch(instancedShader, "shader4_instanced.vs", "shader4.fs");
     ourShader.use();
     
-    glUniform1i(glGetUniformLocation(ourShader.ID, "ourTexture"), 0); // 手动设置
+    Uniform<int>(ourShader, OUR_TEXTURE) = 0;
     glEnable(GL_DEPTH_TEST);
+
+    // resolve uniforms once, the render loop only sets through handles
+    Uniform<glm::mat4> modelUniform(ourShader, MODEL);
+
+    instancedShader.use();
+    Uniform<int>(instancedShader, OUR_TEXTURE) = 0;
+
+    mvpShader.use();
+    Uniform<int>(mvpShader, OUR_TEXTURE) = 0;
+    Uniform<glm::mat4> mvpUniform(mvpShader, MVP);
+    instancedMvpShader.use();
+    Uniform<int>(instancedMvpShader, OUR_TEXTURE) = 0;
+
+    InstanceBuffer instances;
+    instances.attach(VAO, 3);
+
+    if (benchmark)
+    {
+        glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f, 0.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.f / 600.f, 0.1f, 100.0f);
+        camera.update(glm::value_ptr(view), glm::value_ptr(projection));
+        CubePrograms programs = { ourShader, instancedShader, mvpShader, instancedMvpShader, modelUniform, mvpUniform };
+        runCubeBenchmark(window, maxCubes, cube, programs, instances, projection * view);
+        glfwTerminate();
+        return 0;
+    }
     
-    glm::vec3 cubePositions[] = {
+    std::vector<glm::vec3> cubePositions = {
       glm::vec3( 0.0f,  0.0f,  0.0f),
       glm::vec3( 2.0f,  5.0f, -15.0f),
       glm::vec3(-1.5f, -2.2f, -2.5f),
@@ -173,6 +372,15 @@ int main()
       glm::vec3( 1.5f,  0.2f, -1.5f),
       glm::vec3(-1.3f,  1.0f, -1.5f)
     };
+    // the cubes as entities, each frame only advances their angles
+    EntityStore scene;
+    buildCubeScene(cubePositions, scene);
+    CubeFrame cubeFrame;
+    float lastTime = (float)glfwGetTime();
+
+    // matrices, culling and the instance data are built on every core, this
+    // thread only submits
+    JobPool jobs;
     
     // render loop
     // -----------
@@ -181,6 +389,9 @@ int main()
         // input
         // -----
         processInput5(window);
+        Shader::frameStats().reset();
+        glstate().frameStats().reset();
+        shaderWatcher.poll();
         
         // render
         // ------
@@ -200,23 +411,24 @@ int main()
         glm::mat4 projection = glm::mat4(1.0f);
         projection = glm::perspective(glm::radians(45.0f), 800.f / 600.f, 0.1f, 100.0f);
         
-        int viewLoc = glGetUniformLocation(ourShader.ID, "view");
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-
-        int projectionLoc = glGetUniformLocation(ourShader.ID, "projection");
-        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
+        camera.update(glm::value_ptr(view), glm::value_ptr(projection));
 
-        glBindVertexArray(VAO);
-        for(unsigned int i = 0; i < 10; i++)
+        // every visible cube in one draw. angles are absolute, no time scale
+        float now = (float)glfwGetTime();
+        spinEntities(scene, now - lastTime);
+        lastTime = now;
+        glm::mat4 viewProjection = projection * view;
+        updateVisibleCubes(jobs, scene.transforms, Frustum(glm::value_ptr(viewProjection)),
+                           premultiplied ? glm::value_ptr(viewProjection) : NULL, 1.0f, cubeFrame);
+        if (cubeFrame.visibleCount)
         {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, cubePositions[i]);
-            float angle = 20.0f * i;
-            model = glm::rotate(model, (float)glfwGetTime() * glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-            int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            instances.update(glm::value_ptr(cubeFrame.visible[0]), cubeFrame.visibleCount);
+            if (premultiplied)
+                instancedMvpShader.use();
+            else
+                instancedShader.use();
+            glstate().bindVertexArray(VAO);
+            glDrawElementsInstanced(GL_TRIANGLES, cube.indexCount, cube.indexType, 0, (GLsizei)cubeFrame.visibleCount);
         }
         
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -225,6 +437,11 @@ int main()
         glfwPollEvents();
     }
 
+    std::cout << "UNIFORM_UPLOADS last frame: issued=" << Shader::frameStats().issued
+              << " elided=" << Shader::frameStats().elided << std::endl;
+    std::cout << "GL_STATE last frame: issued=" << glstate().frameStats().issued
+              << " elided=" << glstate().frameStats().elided << std::endl;
+
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
     glfwTerminate();
@@ -237,3 +454,457 @@ void framebuffer_size_callback5(GLFWwindow* window, int width, int height)
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
 }
+
+// keeps the existing positions and scatters the rest in front of the camera
+// ---------------------------------------------------------------------------------------------------------
+void fillCubeField(std::vector<glm::vec3>& positions, size_t count)
+{
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> spread(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> depth(-95.0f, -5.0f);
+    positions.reserve(count);
+    while (positions.size() < count)
+        positions.push_back(glm::vec3(spread(random), spread(random), depth(random)));
+    positions.resize(count);
+}
+
+// cube i spins around (1, 0.3, 0.5) at 20 * (i % 18) degrees per second. the
+// first ten keep their old speeds, past that the speeds repeat
+// ---------------------------------------------------------------------------------------------------------
+void buildCubeTransforms(const std::vector<glm::vec3>& positions, TransformSoA& transforms)
+{
+    const float axis[3] = { 1.0f, 0.3f, 0.5f };
+    transforms.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+        transforms.set(i, glm::value_ptr(positions[i]), axis, glm::radians(20.0f * (i % 18)));
+}
+
+// the same cubes as entities: angle 0, the speed in spin
+// ---------------------------------------------------------------------------------------------------------
+void buildCubeScene(const std::vector<glm::vec3>& positions, EntityStore& scene)
+{
+    scene.clear();
+    scene.reserve(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        if (createCube(scene, positions[i], glm::radians(20.0f * (i % 18))) == EntityStore::INVALID)
+            return;
+    }
+}
+
+// one cube entity, INVALID when the store is full
+// ---------------------------------------------------------------------------------------------------------
+unsigned int createCube(EntityStore& scene, const glm::vec3& position, float spin)
+{
+    const float axis[3] = { 1.0f, 0.3f, 0.5f };
+    unsigned int cube = scene.create();
+    if (cube == EntityStore::INVALID)
+        return cube;
+    size_t index = scene.index(cube);
+    scene.transforms.set(index, glm::value_ptr(position), axis, 0.0f);
+    scene.spin[index] = spin;
+    scene.mesh[index] = CUBE_MESH;
+    scene.material[index] = CONTAINER_MATERIAL;
+    return cube;
+}
+
+// angle += spin * deltaTime, kept in [-pi, pi] for the kernels' range
+// reduction. reads two arrays, writes one
+// ---------------------------------------------------------------------------------------------------------
+void spinEntities(EntityStore& scene, float deltaTime)
+{
+    const float PI = 3.14159265f;
+    float* angle = scene.transforms.angle.data();
+    const float* spin = scene.spin.data();
+    for (size_t i = 0, count = scene.size(); i < count; i++)
+    {
+        float a = angle[i] + spin[i] * deltaTime;
+        a = a > PI ? a - 2.0f * PI : a;
+        angle[i] = a < -PI ? a + 2.0f * PI : a;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------
+void updateCubeModels(const TransformSoA& transforms, std::vector<glm::mat4>& models, float time)
+{
+    models.resize(transforms.size());
+    if (!models.empty())
+        TransformBatch::modelMatrices(transforms, time, glm::value_ptr(models[0]));
+}
+
+// projection * view folded into every cube's matrix, once per cube instead of
+// once per vertex on the GPU
+// ---------------------------------------------------------------------------------------------------------
+void updateCubeMvps(const TransformSoA& transforms, const glm::mat4& viewProjection, std::vector<glm::mat4>& mvps, float time)
+{
+    mvps.resize(transforms.size());
+    if (!mvps.empty())
+        TransformBatch::mvpMatrices(transforms, time, glm::value_ptr(viewProjection), glm::value_ptr(mvps[0]));
+}
+
+// one object at a time, what updateCubeModels computes. kept as the baseline
+// ---------------------------------------------------------------------------------------------------------
+void updateCubeModelsGlm(const std::vector<glm::vec3>& positions, std::vector<glm::mat4>& models, float time)
+{
+    models.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, positions[i]);
+        // the first ten keep their old speeds, past that the speeds repeat
+        float angle = 20.0f * (i % 18);
+        model = glm::rotate(model, time * glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+        models[i] = model;
+    }
+}
+
+// draws growing cube fields with every path and prints the average frame time.
+// glFinish makes the time include the GPU, vsync is off so it is not capped.
+// the -mvp paths differ from their plain ones only in the vertex stage, on a
+// software rasterizer the gap between the two is what it saves per vertex.
+// ---------------------------------------------------------------------------------------------------------
+void runCubeBenchmark(GLFWwindow* window, size_t maxCubes, const CubeGeometry& cube, CubePrograms& programs,
+                      InstanceBuffer& instances, const glm::mat4& viewProjection)
+{
+    const int FRAMES = 60;
+    // one draw per cube is only measured while it finishes in reasonable time
+    const size_t MAX_PER_DRAW = 100000;
+    enum Path { PER_DRAW, PER_DRAW_MVP, MULTI_DRAW, INSTANCED, INSTANCED_MVP, PATH_COUNT };
+    const char* PATH_NAMES[] = { "per-draw", "per-draw-mvp", "multi-draw", "instanced", "instanced-mvp" };
+
+    // each cube as its own command, as if they were all different meshes
+    IndirectBatch batch(instances, 3);
+
+    glfwSwapInterval(0);
+    std::vector<size_t> counts;
+    for (size_t cubes = 10; cubes < maxCubes; cubes *= 10)
+        counts.push_back(cubes);
+    counts.push_back(maxCubes);
+
+    std::vector<glm::vec3> positions;
+    TransformSoA transforms;
+    std::vector<glm::mat4> models;
+    for (size_t cubes : counts)
+    {
+        fillCubeField(positions, cubes);
+        buildCubeTransforms(positions, transforms);
+        for (int path = 0; path < PATH_COUNT; path++)
+        {
+            // without GL 4.3 the batch replays one call per cube as well
+            bool oneCallPerCube = path == PER_DRAW || path == PER_DRAW_MVP || (path == MULTI_DRAW && !glext().multiDrawIndirect);
+            bool mvp = path == PER_DRAW_MVP || path == INSTANCED_MVP;
+            if (oneCallPerCube && cubes > MAX_PER_DRAW)
+                continue;
+
+            double matrixMs = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < FRAMES; frame++)
+            {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+                auto matrixStart = std::chrono::steady_clock::now();
+                if (mvp)
+                    updateCubeMvps(transforms, viewProjection, models, frame / 60.0f);
+                else
+                    updateCubeModels(transforms, models, frame / 60.0f);
+                matrixMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - matrixStart).count();
+
+                glstate().bindVertexArray(cube.VAO);
+                if (path == INSTANCED || path == INSTANCED_MVP)
+                {
+                    instances.update(glm::value_ptr(models[0]), models.size());
+                    if (mvp)
+                        programs.instancedMvp.use();
+                    else
+                        programs.instanced.use();
+                    glDrawElementsInstanced(GL_TRIANGLES, cube.indexCount, cube.indexType, 0, (GLsizei)models.size());
+                }
+                else if (path == MULTI_DRAW)
+                {
+                    for (size_t i = 0; i < models.size(); i++)
+                        batch.drawElements(programs.instanced.ID, cube.VAO, cube.indexType, 0, (unsigned int)cube.indexCount, 0, glm::value_ptr(models[i]));
+                    batch.flush();
+                }
+                else
+                {
+                    (mvp ? programs.perDrawMvp : programs.perDraw).use();
+                    Uniform<glm::mat4>& matrix = mvp ? programs.mvp : programs.model;
+                    for (size_t i = 0; i < models.size(); i++)
+                    {
+                        matrix = models[i];
+                        glDrawElements(GL_TRIANGLES, cube.indexCount, cube.indexType, 0);
+                    }
+                }
+                glFinish();
+                glfwSwapBuffers(window);
+                glfwPollEvents();
+            }
+            double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+
+            std::cout << "BENCHMARK cubes=" << cubes << " path=" << PATH_NAMES[path]
+                      << " frame=" << frameMs << "ms matrices=" << matrixMs / FRAMES << "ms" << std::endl;
+        }
+    }
+}
+
+// model matrices for 1k, 100k and 1M cubes, glm one by one against each
+// TransformBatch kernel the CPU has. the 1M case writes 64MB per update and
+// is bound by memory bandwidth more than by arithmetic.
+// ---------------------------------------------------------------------------------------------------------
+void runTransformBenchmark()
+{
+    const size_t COUNTS[] = { 1000, 100000, 1000000 };
+    std::vector<glm::vec3> positions;
+    TransformSoA transforms;
+    std::vector<glm::mat4> reference, models;
+    for (size_t cubes : COUNTS)
+    {
+        fillCubeField(positions, cubes);
+        buildCubeTransforms(positions, transforms);
+        reference.resize(cubes);
+        models.resize(cubes);
+        // about 100M matrices per row, enough to average out the small counts
+        const int RUNS = (int)(100000000 / cubes < 1000 ? 100000000 / cubes : 1000);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < RUNS; run++)
+            updateCubeModelsGlm(positions, reference, run / 60.0f);
+        double glmMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / RUNS;
+        std::cout << "TRANSFORM cubes=" << cubes << " path=glm " << glmMs << "ms" << std::endl;
+
+        for (int path = TransformBatch::SCALAR; path <= TransformBatch::bestPath(); path++)
+        {
+            start = std::chrono::steady_clock::now();
+            for (int run = 0; run < RUNS; run++)
+                TransformBatch::modelMatrices(transforms, run / 60.0f, glm::value_ptr(models[0]), 0, cubes, (TransformBatch::Path)path);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / RUNS;
+
+            // both ran RUNS - 1 last, compare against glm
+            float error = 0.0f;
+            for (size_t i = 0; i < cubes; i++)
+            {
+                const float* a = glm::value_ptr(reference[i]);
+                const float* b = glm::value_ptr(models[i]);
+                for (int k = 0; k < 16; k++)
+                    error = std::max(error, std::fabs(a[k] - b[k]));
+            }
+            std::cout << "TRANSFORM cubes=" << cubes << " path=" << TransformBatch::pathName((TransformBatch::Path)path)
+                      << " " << ms << "ms speedup=" << glmMs / ms << "x maxError=" << error << std::endl;
+        }
+    }
+}
+
+// the instanced path's CPU side in two parallel passes over 4096-cube chunks:
+// matrices + frustum test + count per chunk, then each chunk copies its
+// visible cubes to its offset in the packed upload array. with viewProjection
+// the matrices come out premultiplied, NULL leaves them model matrices
+// ---------------------------------------------------------------------------------------------------------
+void updateVisibleCubes(JobPool& jobs, const TransformSoA& transforms, const Frustum& frustum, const float* viewProjection,
+                        float time, CubeFrame& frame)
+{
+    const size_t CHUNK = 4096;
+    size_t count = transforms.size();
+    size_t chunks = (count + CHUNK - 1) / CHUNK;
+    frame.models.resize(count);
+    frame.inside.resize(count);
+    frame.visible.resize(count);
+    frame.chunkOffsets.assign(chunks + 1, 0);
+    frame.visibleCount = 0;
+    if (!count)
+        return;
+
+    jobs.parallelFor(count, CHUNK, [&](size_t begin, size_t end)
+    {
+        TransformBatch::mvpMatrices(transforms, time, viewProjection, glm::value_ptr(frame.models[0]), begin, end);
+        size_t visible = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            bool inside = frustum.sphereVisible(transforms.x[i], transforms.y[i], transforms.z[i], CUBE_RADIUS * transforms.scale[i]);
+            frame.inside[i] = inside;
+            visible += inside;
+        }
+        frame.chunkOffsets[begin / CHUNK + 1] = visible;
+    });
+
+    for (size_t c = 0; c < chunks; c++)
+        frame.chunkOffsets[c + 1] += frame.chunkOffsets[c];
+    frame.visibleCount = frame.chunkOffsets[chunks];
+
+    jobs.parallelFor(count, CHUNK, [&](size_t begin, size_t end)
+    {
+        glm::mat4* out = frame.visible.data() + frame.chunkOffsets[begin / CHUNK];
+        for (size_t i = begin; i < end; i++)
+        {
+            if (frame.inside[i])
+                *out++ = frame.models[i];
+        }
+    });
+}
+
+// updateVisibleCubes on the benchmark camera with 1 to N threads, speedup
+// against one thread. no GL, the numbers are the CPU frame cost alone
+// ---------------------------------------------------------------------------------------------------------
+void runJobScalingBenchmark(size_t cubes)
+{
+    const int FRAMES = 30;
+    std::vector<glm::vec3> positions;
+    fillCubeField(positions, cubes);
+    TransformSoA transforms;
+    buildCubeTransforms(positions, transforms);
+
+    glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f, 0.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.f / 600.f, 0.1f, 100.0f);
+    Frustum frustum(glm::value_ptr(projection * view));
+
+    unsigned int maxThreads = JobPool::defaultWorkers() + 1;
+    double singleMs = 0.0;
+    CubeFrame frame;
+    for (unsigned int threads = 1; threads <= maxThreads; threads++)
+    {
+        JobPool jobs(threads - 1);
+        // first frame sizes the arrays and faults the pages in
+        updateVisibleCubes(jobs, transforms, frustum, NULL, 0.0f, frame);
+        jobs.stats().reset();
+
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < FRAMES; f++)
+            updateVisibleCubes(jobs, transforms, frustum, NULL, f / 60.0f, frame);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+        if (threads == 1)
+            singleMs = ms;
+
+        std::cout << "JOBS cubes=" << cubes << " threads=" << threads << " frame=" << ms << "ms speedup=" << singleMs / ms
+                  << "x visible=" << frame.visibleCount << " steals=" << jobs.stats().steals / FRAMES << std::endl;
+    }
+}
+
+// the cube field as a scene graph: one root, a group node per 1000 cubes,
+// each cube a child of its group. every frame sets the local matrix of some
+// cubes, or moves one group and with it its 1000 cubes, then updates the
+// world matrices incrementally and, for comparison, all of them. the render
+// loop does not use the hierarchy: every cube there spins each frame, so
+// there is nothing static for it to skip
+// ---------------------------------------------------------------------------------------------------------
+void runHierarchyBenchmark(size_t cubes)
+{
+    const int FRAMES = 30;
+    const size_t GROUP = 1000;
+    if (!cubes)
+        return;
+    const glm::vec3 axis(1.0f, 0.3f, 0.5f);
+    std::vector<glm::vec3> positions;
+    fillCubeField(positions, cubes);
+
+    // depth-first, every add appends
+    TransformHierarchy scene;
+    std::vector<unsigned int> groups, leaves;
+    unsigned int root = scene.add();
+    for (size_t i = 0; i < cubes; i++)
+    {
+        if (i % GROUP == 0)
+        {
+            groups.push_back(scene.add(root));
+            glm::mat4 group = glm::translate(glm::mat4(1.0f), positions[i]);
+            scene.setLocal(groups.back(), glm::value_ptr(group));
+        }
+        leaves.push_back(scene.add(groups.back()));
+        glm::mat4 local = glm::translate(glm::mat4(1.0f), positions[i] - positions[i / GROUP * GROUP]);
+        scene.setLocal(leaves.back(), glm::value_ptr(local));
+    }
+    scene.update();
+
+    std::mt19937 random(11);
+    const double MOVED[] = { 0.0, 0.001, 0.01, 0.1, 1.0 };
+    for (int row = 0; row <= 5; row++)
+    {
+        // rows 0..4 move a fraction of the cubes, row 5 one whole group
+        bool groupRow = row == 5;
+        size_t moved = groupRow ? 1 : (size_t)(cubes * MOVED[row]);
+        double ms[2] = { 0.0, 0.0 };
+        size_t updated = 0;
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (int f = 0; f < FRAMES; f++)
+            {
+                float angle = (f + 1) / 60.0f;
+                auto start = std::chrono::steady_clock::now();
+                for (size_t m = 0; m < moved; m++)
+                {
+                    unsigned int node = groupRow ? groups[random() % groups.size()] : leaves[random() % leaves.size()];
+                    glm::mat4 local = glm::rotate(glm::make_mat4(scene.local(node)), angle, axis);
+                    scene.setLocal(node, glm::value_ptr(local));
+                }
+                updated = pass == 0 ? scene.update() : scene.updateAll();
+                ms[pass] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+            if (pass == 0)
+                std::cout << "HIERARCHY nodes=" << scene.size() << " moved=" << (groupRow ? "1 group" : std::to_string(moved))
+                          << " recomputed=" << updated << " update=" << ms[0] / FRAMES << "ms";
+        }
+        std::cout << " full=" << ms[1] / FRAMES << "ms" << std::endl;
+    }
+}
+
+// a million-cube EntityStore: churned by destroying and recreating a tenth
+// of it, then the two per-frame systems, spin and model matrices, timed
+// apart. both are linear passes over dense arrays, so bytes moved per frame
+// over time is the number to hold against the memory bandwidth.
+// ---------------------------------------------------------------------------------------------------------
+void runEntityBenchmark(size_t entities)
+{
+    const int FRAMES = 30;
+    if (!entities)
+        return;
+    std::vector<glm::vec3> positions;
+    fillCubeField(positions, entities);
+    EntityStore scene;
+    buildCubeScene(positions, scene);
+
+    // swap-removes scatter the survivors' order, the arrays stay dense. each
+    // destroyed cube comes back where it was, so the field is the same after
+    std::mt19937 random(5);
+    std::vector<unsigned int> doomed;
+    for (size_t i = 0; i < scene.size() / 10; i++)
+        doomed.push_back(scene.entity(random() % scene.size()));
+    std::vector<glm::vec3> doomedPositions;
+    std::vector<float> doomedSpins;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int entity : doomed)
+    {
+        unsigned int index = scene.index(entity);
+        if (index == EntityStore::INVALID)
+            continue;
+        doomedPositions.push_back(glm::vec3(scene.transforms.x[index], scene.transforms.y[index], scene.transforms.z[index]));
+        doomedSpins.push_back(scene.spin[index]);
+        scene.destroy(entity);
+    }
+    size_t destroyed = doomedPositions.size();
+    for (size_t i = 0; i < destroyed; i++)
+    {
+        if (createCube(scene, doomedPositions[i], doomedSpins[i]) == EntityStore::INVALID)
+            break;
+    }
+    double churnMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<glm::mat4> models(scene.size());
+    double spinMs = 0.0, matrixMs = 0.0;
+    for (int f = 0; f < FRAMES; f++)
+    {
+        start = std::chrono::steady_clock::now();
+        spinEntities(scene, 1.0f / 60.0f);
+        auto spun = std::chrono::steady_clock::now();
+        TransformBatch::modelMatrices(scene.transforms, 1.0f, glm::value_ptr(models[0]));
+        auto end = std::chrono::steady_clock::now();
+        spinMs += std::chrono::duration<double, std::milli>(spun - start).count();
+        matrixMs += std::chrono::duration<double, std::milli>(end - spun).count();
+    }
+    spinMs /= FRAMES;
+    matrixMs /= FRAMES;
+
+    // spin: angle and spin in, angle out. matrices: 8 floats in, 16 out
+    double count = (double)scene.size();
+    std::cout << "ENTITIES count=" << scene.size() << " churn=" << destroyed << " destroyed+created in " << churnMs << "ms" << std::endl;
+    std::cout << "ENTITIES system=spin " << spinMs << "ms " << count * 12 / spinMs / 1e6 << "GB/s" << std::endl;
+    std::cout << "ENTITIES system=matrices path=" << TransformBatch::pathName(TransformBatch::bestPath()) << " " << matrixMs << "ms "
+              << count * 96 / matrixMs / 1e6 << "GB/s" << std::endl;
+}
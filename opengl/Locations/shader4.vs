@@ -4,12 +4,21 @@ layout (location = 2) in vec2 aTexture;
 
 out vec2 vTexture;
 
+#include "camera.glsl"
+
+#ifdef PREMULTIPLIED_MVP
+// projection * view * model, multiplied once per object on the CPU
+uniform mat4 mvp;
+#else
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#endif
 
 void main()
 {
+#ifdef PREMULTIPLIED_MVP
+    gl_Position = mvp * vec4(aPos.x, aPos.y, aPos.z, 1.0);
+#else
     gl_Position = projection * view * model * vec4(aPos.x, aPos.y, aPos.z, 1.0);
+#endif
     vTexture = aTexture;
 }
@@ -0,0 +1,20 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexture;
+// one model matrix per instance, takes locations 3 to 6. with
+// PREMULTIPLIED_MVP it already holds projection * view * model
+layout (location = 3) in mat4 aModel;
+
+out vec2 vTexture;
+
+#include "camera.glsl"
+
+void main()
+{
+#ifdef PREMULTIPLIED_MVP
+    gl_Position = aModel * vec4(aPos.x, aPos.y, aPos.z, 1.0);
+#else
+    gl_Position = projection * view * aModel * vec4(aPos.x, aPos.y, aPos.z, 1.0);
+#endif
+    vTexture = aTexture;
+}
@@ -0,0 +1,62 @@
+//
+//  Frustum.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef Frustum_h
+#define Frustum_h
+
+#include <cmath>
+
+// the six clip planes of a column-major projection * view matrix
+// (Gribb/Hartmann), normals pointing inwards and normalized so sphere tests
+// compare against real distances.
+//
+//   Frustum frustum(glm::value_ptr(projection * view));
+//   if (frustum.sphereVisible(x, y, z, radius)) ...
+struct Frustum
+{
+    float planes[6][4];
+
+    Frustum()
+        : planes{}
+    {
+    }
+    explicit Frustum(const float* viewProjection)
+    {
+        extract(viewProjection);
+    }
+    // ------------------------------------------------------------------------
+    void extract(const float* m)
+    {
+        // plane = row 3 +- row 0, 1, 2; row r of a column-major matrix is m[r], m[4 + r], ...
+        for (int p = 0; p < 6; p++)
+        {
+            int row = p / 2;
+            float sign = p % 2 ? -1.0f : 1.0f;
+            for (int c = 0; c < 4; c++)
+                planes[p][c] = m[c * 4 + 3] + sign * m[c * 4 + row];
+            float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+            if (length > 0.0f)
+            {
+                for (int c = 0; c < 4; c++)
+                    planes[p][c] /= length;
+            }
+        }
+    }
+    // conservative, a sphere near a frustum corner may pass while outside
+    // ------------------------------------------------------------------------
+    bool sphereVisible(float x, float y, float z, float radius) const
+    {
+        for (int p = 0; p < 6; p++)
+        {
+            if (planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3] < -radius)
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif /* Frustum_h */
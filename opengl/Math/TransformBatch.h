@@ -0,0 +1,366 @@
+//
+//  TransformBatch.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef TransformBatch_h
+#define TransformBatch_h
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TRANSFORM_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+// per-object transforms as structure of arrays, one array per component, so
+// a kernel loads 4 or 8 objects' x with one instruction. axes are unit length,
+// scale is uniform.
+struct TransformSoA
+{
+    std::vector<float> x, y, z;
+    std::vector<float> axisX, axisY, axisZ;
+    std::vector<float> angle;
+    std::vector<float> scale;
+
+    size_t size() const
+    {
+        return x.size();
+    }
+    // ------------------------------------------------------------------------
+    void resize(size_t count)
+    {
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+        axisX.resize(count);
+        axisY.resize(count);
+        axisZ.resize(count);
+        angle.resize(count);
+        scale.resize(count, 1.0f);
+    }
+    // axis is normalized here, the kernels rely on it
+    // ------------------------------------------------------------------------
+    void set(size_t i, const float position[3], const float axis[3], float radians, float size = 1.0f)
+    {
+        x[i] = position[0];
+        y[i] = position[1];
+        z[i] = position[2];
+        float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        float normalize = length > 0.0f ? 1.0f / length : 0.0f;
+        axisX[i] = axis[0] * normalize;
+        axisY[i] = axis[1] * normalize;
+        axisZ[i] = axis[2] * normalize;
+        angle[i] = radians;
+        scale[i] = size;
+    }
+};
+
+// model = translate(position) * rotate(angle * angleScale, axis) * scale for
+// a whole array of objects, the same matrices glm::translate + glm::rotate +
+// glm::scale build one at a time. output is column-major, 16 floats per object, ready for an
+// InstanceBuffer. angleScale lets angle hold speeds and the caller pass time.
+//
+//   TransformBatch::modelMatrices(transforms, time, glm::value_ptr(models[0]));
+//   TransformBatch::mvpMatrices(transforms, time, glm::value_ptr(projection * view), glm::value_ptr(mvps[0]));
+//
+// mvpMatrices folds projection * view in as well, so a vertex shader needs a
+// single mat4 * vec4 per vertex instead of three.
+//
+// x86 builds carry SSE4.1 and AVX2 kernels (4 and 8 objects per iteration,
+// polynomial sin/cos) and pick one at run time; everything else, and the
+// tail of each array, goes through the scalar loop.
+class TransformBatch
+{
+public:
+    enum Path
+    {
+        SCALAR,
+        SSE4,
+        AVX2,
+    };
+
+    // widest kernel the running CPU supports
+    // ------------------------------------------------------------------------
+    static Path bestPath()
+    {
+#ifdef TRANSFORM_BATCH_X86
+        static const Path best = __builtin_cpu_supports("avx2") ? AVX2 : __builtin_cpu_supports("sse4.1") ? SSE4 : SCALAR;
+        return best;
+#else
+        return SCALAR;
+#endif
+    }
+    static const char* pathName(Path path)
+    {
+        return path == AVX2 ? "avx2" : path == SSE4 ? "sse4" : "scalar";
+    }
+    // objects [begin, end) of transforms into out, which holds 16 floats per
+    // object of the whole array. path falls back when the CPU lacks it
+    // ------------------------------------------------------------------------
+    static void modelMatrices(const TransformSoA& transforms, float angleScale, float* out,
+                              size_t begin = 0, size_t end = (size_t)-1, Path path = bestPath())
+    {
+        run(transforms, angleScale, NULL, out, begin, end, path);
+    }
+    // viewProjection * model, viewProjection column-major. NULL gives what
+    // modelMatrices does
+    // ------------------------------------------------------------------------
+    static void mvpMatrices(const TransformSoA& transforms, float angleScale, const float* viewProjection, float* out,
+                            size_t begin = 0, size_t end = (size_t)-1, Path path = bestPath())
+    {
+        run(transforms, angleScale, viewProjection, out, begin, end, path);
+    }
+    // viewProjection may be NULL for plain model matrices
+    // ------------------------------------------------------------------------
+    static void matricesScalar(const TransformSoA& t, float angleScale, const float* viewProjection, float* out, size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            float a = t.angle[i] * angleScale;
+            float c = std::cos(a), s = std::sin(a);
+            // scaling c, 1 - c and s scales the rotation columns
+            float k = (1.0f - c) * t.scale[i];
+            c *= t.scale[i];
+            s *= t.scale[i];
+            float ax = t.axisX[i], ay = t.axisY[i], az = t.axisZ[i];
+            float tx = k * ax, ty = k * ay, tz = k * az;
+
+            float model[16] = {
+                c + tx * ax,       tx * ay + s * az,  tx * az - s * ay,  0.0f,
+                ty * ax - s * az,  c + ty * ay,       ty * az + s * ax,  0.0f,
+                tz * ax + s * ay,  tz * ay - s * ax,  c + tz * az,       0.0f,
+                t.x[i],            t.y[i],            t.z[i],            1.0f,
+            };
+            float* m = out + i * 16;
+            if (!viewProjection)
+            {
+                for (int n = 0; n < 16; n++)
+                    m[n] = model[n];
+                continue;
+            }
+            const float* vp = viewProjection;
+            for (int column = 0; column < 4; column++)
+            {
+                for (int row = 0; row < 4; row++)
+                {
+                    m[column * 4 + row] = vp[row] * model[column * 4] + vp[4 + row] * model[column * 4 + 1]
+                        + vp[8 + row] * model[column * 4 + 2] + vp[12 + row] * model[column * 4 + 3];
+                }
+            }
+        }
+    }
+
+#ifdef TRANSFORM_BATCH_X86
+    // both kernels: range reduce to r in [-pi/4, pi/4] around the nearest
+    // multiple q of pi/2 (pi/2 split in three so q * pi/2 stays exact), take
+    // sin and cos of r from minimax polynomials, then swap and negate by the
+    // quadrant q mod 4. about 1 ulp on [-pi/4, pi/4], fine for angles up to
+    // a few thousand radians. e[] holds the 16 matrix elements, column-major,
+    // each for 4 or 8 objects. returns where the scalar tail starts.
+    // ------------------------------------------------------------------------
+    __attribute__((target("sse4.1")))
+    static size_t matricesSSE4(const TransformSoA& t, float angleScale, const float* viewProjection, float* out, size_t begin, size_t end)
+    {
+        const __m128 scale = _mm_set1_ps(angleScale);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        __m128 vp[16];
+        for (int k = 0; k < 16; k++)
+            vp[k] = _mm_set1_ps(viewProjection ? viewProjection[k] : 0.0f);
+
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 a = _mm_mul_ps(_mm_loadu_ps(&t.angle[i]), scale);
+            __m128 q = _mm_round_ps(_mm_mul_ps(a, _mm_set1_ps(0.63661977f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            __m128 r = _mm_sub_ps(a, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+            r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+            r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(7.54978995489188216e-8f)));
+            __m128 z = _mm_mul_ps(r, r);
+
+            __m128 sr = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), z), _mm_set1_ps(8.3321608736e-3f));
+            sr = _mm_add_ps(_mm_mul_ps(sr, z), _mm_set1_ps(-1.6666654611e-1f));
+            sr = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sr, z), r), r);
+            __m128 cr = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), z), _mm_set1_ps(-1.388731625493765e-3f));
+            cr = _mm_add_ps(_mm_mul_ps(cr, z), _mm_set1_ps(4.166664568298827e-2f));
+            cr = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(cr, z), z), _mm_sub_ps(one, _mm_mul_ps(_mm_set1_ps(0.5f), z)));
+
+            __m128i quadrant = _mm_cvtps_epi32(q);
+            __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+            __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+            __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+            __m128 s = _mm_xor_ps(_mm_blendv_ps(sr, cr, swap), sinSign);
+            __m128 c = _mm_xor_ps(_mm_blendv_ps(cr, sr, swap), cosSign);
+
+            __m128 ax = _mm_loadu_ps(&t.axisX[i]), ay = _mm_loadu_ps(&t.axisY[i]), az = _mm_loadu_ps(&t.axisZ[i]);
+            __m128 size = _mm_loadu_ps(&t.scale[i]);
+            __m128 k = _mm_mul_ps(_mm_sub_ps(one, c), size);
+            c = _mm_mul_ps(c, size);
+            s = _mm_mul_ps(s, size);
+            __m128 tx = _mm_mul_ps(k, ax), ty = _mm_mul_ps(k, ay), tz = _mm_mul_ps(k, az);
+            __m128 sx = _mm_mul_ps(s, ax), sy = _mm_mul_ps(s, ay), sz = _mm_mul_ps(s, az);
+
+            __m128 e[16] = {
+                _mm_add_ps(c, _mm_mul_ps(tx, ax)), _mm_add_ps(_mm_mul_ps(tx, ay), sz), _mm_sub_ps(_mm_mul_ps(tx, az), sy), zero,
+                _mm_sub_ps(_mm_mul_ps(ty, ax), sz), _mm_add_ps(c, _mm_mul_ps(ty, ay)), _mm_add_ps(_mm_mul_ps(ty, az), sx), zero,
+                _mm_add_ps(_mm_mul_ps(tz, ax), sy), _mm_sub_ps(_mm_mul_ps(tz, ay), sx), _mm_add_ps(c, _mm_mul_ps(tz, az)), zero,
+                _mm_loadu_ps(&t.x[i]), _mm_loadu_ps(&t.y[i]), _mm_loadu_ps(&t.z[i]), one,
+            };
+            if (viewProjection)
+            {
+                // model columns 0..2 have w = 0 and column 3 has w = 1, so
+                // each result element is three products, plus vp's last column
+                __m128 m[16];
+                for (int column = 0; column < 4; column++)
+                {
+                    for (int row = 0; row < 4; row++)
+                    {
+                        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vp[row], e[column * 4]), _mm_mul_ps(vp[4 + row], e[column * 4 + 1])),
+                                                _mm_mul_ps(vp[8 + row], e[column * 4 + 2]));
+                        m[column * 4 + row] = column == 3 ? _mm_add_ps(sum, vp[12 + row]) : sum;
+                    }
+                }
+                for (int n = 0; n < 16; n++)
+                    e[n] = m[n];
+            }
+
+            float* m = out + i * 16;
+            for (int column = 0; column < 4; column++)
+                storeColumns(m + column * 4, e[column * 4], e[column * 4 + 1], e[column * 4 + 2], e[column * 4 + 3]);
+        }
+        return i;
+    }
+    // ------------------------------------------------------------------------
+    __attribute__((target("avx2")))
+    static size_t matricesAVX2(const TransformSoA& t, float angleScale, const float* viewProjection, float* out, size_t begin, size_t end)
+    {
+        const __m256 scale = _mm256_set1_ps(angleScale);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 zero = _mm256_setzero_ps();
+        __m256 vp[16];
+        for (int k = 0; k < 16; k++)
+            vp[k] = _mm256_set1_ps(viewProjection ? viewProjection[k] : 0.0f);
+
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            __m256 a = _mm256_mul_ps(_mm256_loadu_ps(&t.angle[i]), scale);
+            __m256 q = _mm256_round_ps(_mm256_mul_ps(a, _mm256_set1_ps(0.63661977f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+            __m256 r = _mm256_sub_ps(a, _mm256_mul_ps(q, _mm256_set1_ps(1.5703125f)));
+            r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(4.837512969970703125e-4f)));
+            r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(7.54978995489188216e-8f)));
+            __m256 z = _mm256_mul_ps(r, r);
+
+            __m256 sr = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-1.9515295891e-4f), z), _mm256_set1_ps(8.3321608736e-3f));
+            sr = _mm256_add_ps(_mm256_mul_ps(sr, z), _mm256_set1_ps(-1.6666654611e-1f));
+            sr = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sr, z), r), r);
+            __m256 cr = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(2.443315711809948e-5f), z), _mm256_set1_ps(-1.388731625493765e-3f));
+            cr = _mm256_add_ps(_mm256_mul_ps(cr, z), _mm256_set1_ps(4.166664568298827e-2f));
+            cr = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(cr, z), z), _mm256_sub_ps(one, _mm256_mul_ps(_mm256_set1_ps(0.5f), z)));
+
+            __m256i quadrant = _mm256_cvtps_epi32(q);
+            __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+            __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+            __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+            __m256 s = _mm256_xor_ps(_mm256_blendv_ps(sr, cr, swap), sinSign);
+            __m256 c = _mm256_xor_ps(_mm256_blendv_ps(cr, sr, swap), cosSign);
+
+            __m256 ax = _mm256_loadu_ps(&t.axisX[i]), ay = _mm256_loadu_ps(&t.axisY[i]), az = _mm256_loadu_ps(&t.axisZ[i]);
+            __m256 size = _mm256_loadu_ps(&t.scale[i]);
+            __m256 k = _mm256_mul_ps(_mm256_sub_ps(one, c), size);
+            c = _mm256_mul_ps(c, size);
+            s = _mm256_mul_ps(s, size);
+            __m256 tx = _mm256_mul_ps(k, ax), ty = _mm256_mul_ps(k, ay), tz = _mm256_mul_ps(k, az);
+            __m256 sx = _mm256_mul_ps(s, ax), sy = _mm256_mul_ps(s, ay), sz = _mm256_mul_ps(s, az);
+
+            __m256 e[16] = {
+                _mm256_add_ps(c, _mm256_mul_ps(tx, ax)), _mm256_add_ps(_mm256_mul_ps(tx, ay), sz), _mm256_sub_ps(_mm256_mul_ps(tx, az), sy), zero,
+                _mm256_sub_ps(_mm256_mul_ps(ty, ax), sz), _mm256_add_ps(c, _mm256_mul_ps(ty, ay)), _mm256_add_ps(_mm256_mul_ps(ty, az), sx), zero,
+                _mm256_add_ps(_mm256_mul_ps(tz, ax), sy), _mm256_sub_ps(_mm256_mul_ps(tz, ay), sx), _mm256_add_ps(c, _mm256_mul_ps(tz, az)), zero,
+                _mm256_loadu_ps(&t.x[i]), _mm256_loadu_ps(&t.y[i]), _mm256_loadu_ps(&t.z[i]), one,
+            };
+            if (viewProjection)
+            {
+                __m256 m[16];
+                for (int column = 0; column < 4; column++)
+                {
+                    for (int row = 0; row < 4; row++)
+                    {
+                        __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vp[row], e[column * 4]), _mm256_mul_ps(vp[4 + row], e[column * 4 + 1])),
+                                                   _mm256_mul_ps(vp[8 + row], e[column * 4 + 2]));
+                        m[column * 4 + row] = column == 3 ? _mm256_add_ps(sum, vp[12 + row]) : sum;
+                    }
+                }
+                for (int n = 0; n < 16; n++)
+                    e[n] = m[n];
+            }
+
+            float* m = out + i * 16;
+            for (int column = 0; column < 4; column++)
+                storeColumns(m + column * 4, e[column * 4], e[column * 4 + 1], e[column * 4 + 2], e[column * 4 + 3]);
+        }
+        return i;
+    }
+#endif
+
+private:
+    // ------------------------------------------------------------------------
+    static void run(const TransformSoA& transforms, float angleScale, const float* viewProjection, float* out,
+                    size_t begin, size_t end, Path path)
+    {
+        end = end < transforms.size() ? end : transforms.size();
+        if (path > bestPath())
+            path = bestPath();
+
+        size_t i = begin;
+#ifdef TRANSFORM_BATCH_X86
+        if (path == AVX2)
+            i = matricesAVX2(transforms, angleScale, viewProjection, out, begin, end);
+        else if (path == SSE4)
+            i = matricesSSE4(transforms, angleScale, viewProjection, out, begin, end);
+#endif
+        matricesScalar(transforms, angleScale, viewProjection, out, i, end);
+    }
+
+#ifdef TRANSFORM_BATCH_X86
+    // rows e0..e3 hold one column's four elements for 4 objects, transposed
+    // so each object's column lands at m + object * 16
+    // ------------------------------------------------------------------------
+    __attribute__((target("sse4.1")))
+    static void storeColumns(float* m, __m128 e0, __m128 e1, __m128 e2, __m128 e3)
+    {
+        __m128 t0 = _mm_unpacklo_ps(e0, e1), t1 = _mm_unpackhi_ps(e0, e1);
+        __m128 t2 = _mm_unpacklo_ps(e2, e3), t3 = _mm_unpackhi_ps(e2, e3);
+        _mm_storeu_ps(m + 0, _mm_movelh_ps(t0, t2));
+        _mm_storeu_ps(m + 16, _mm_movehl_ps(t2, t0));
+        _mm_storeu_ps(m + 32, _mm_movelh_ps(t1, t3));
+        _mm_storeu_ps(m + 48, _mm_movehl_ps(t3, t1));
+    }
+    // same for 8 objects, the transpose runs in each 128-bit half
+    __attribute__((target("avx2")))
+    static void storeColumns(float* m, __m256 e0, __m256 e1, __m256 e2, __m256 e3)
+    {
+        __m256 t0 = _mm256_unpacklo_ps(e0, e1), t1 = _mm256_unpackhi_ps(e0, e1);
+        __m256 t2 = _mm256_unpacklo_ps(e2, e3), t3 = _mm256_unpackhi_ps(e2, e3);
+        __m256 r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm_storeu_ps(m + 0, _mm256_castps256_ps128(r0));
+        _mm_storeu_ps(m + 16, _mm256_castps256_ps128(r1));
+        _mm_storeu_ps(m + 32, _mm256_castps256_ps128(r2));
+        _mm_storeu_ps(m + 48, _mm256_castps256_ps128(r3));
+        _mm_storeu_ps(m + 64, _mm256_extractf128_ps(r0, 1));
+        _mm_storeu_ps(m + 80, _mm256_extractf128_ps(r1, 1));
+        _mm_storeu_ps(m + 96, _mm256_extractf128_ps(r2, 1));
+        _mm_storeu_ps(m + 112, _mm256_extractf128_ps(r3, 1));
+    }
+#endif
+};
+
+#endif /* TransformBatch_h */
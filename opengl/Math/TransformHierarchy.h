@@ -0,0 +1,257 @@
+//
+//  TransformHierarchy.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef TransformHierarchy_h
+#define TransformHierarchy_h
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+// parent/child transforms in one contiguous array, world = parent world *
+// local. nodes are kept in depth-first order, so a parent always comes
+// before its children and every subtree is one contiguous range. setLocal
+// only marks the node; update() then recomputes each marked subtree's range
+// and nothing else, the cost follows what moved rather than the scene size.
+//
+//   TransformHierarchy scene;
+//   unsigned int group = scene.add();
+//   unsigned int cube = scene.add(group);
+//   scene.setLocal(cube, glm::value_ptr(model));
+//   scene.update();
+//   instances.update(scene.worlds(), scene.size());
+//
+// handles stay valid until their node is removed. matrices are column-major,
+// 16 floats, and worlds() is in array order, not handle order.
+class TransformHierarchy
+{
+public:
+    static const unsigned int NONE = 0xFFFFFFFF;
+
+    struct Stats
+    {
+        size_t updated = 0;     // matrices recomputed by the last update
+        size_t subtrees = 0;    // ranges it walked
+    };
+
+    // new node with an identity local matrix as the last child of parent,
+    // NONE for a root. adding under anything but the newest subtree inserts
+    // mid-array and shifts what follows, build large scenes depth-first
+    // ------------------------------------------------------------------------
+    unsigned int add(unsigned int parent = NONE)
+    {
+        if (parent != NONE && !valid(parent))
+            return NONE;
+        unsigned int handle;
+        if (!freeHandles.empty())
+        {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        }
+        else
+        {
+            handle = (unsigned int)indexOf.size();
+            indexOf.push_back(0);
+        }
+
+        const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+        size_t index = parent == NONE ? handleOf.size() : indexOf[parent] + subtree[indexOf[parent]];
+        handleOf.insert(handleOf.begin() + index, handle);
+        parentOf.insert(parentOf.begin() + index, parent);
+        subtree.insert(subtree.begin() + index, 1u);
+        dirty.insert(dirty.begin() + index, (unsigned char)1);
+        localMatrices.insert(localMatrices.begin() + index * 16, identity, identity + 16);
+        worldMatrices.insert(worldMatrices.begin() + index * 16, identity, identity + 16);
+        reindex(index);
+        for (unsigned int ancestor = parent; ancestor != NONE; ancestor = parentOf[indexOf[ancestor]])
+            subtree[indexOf[ancestor]]++;
+        dirtyRoots.push_back(handle);
+        return handle;
+    }
+    // removes the node and everything below it
+    // ------------------------------------------------------------------------
+    void remove(unsigned int handle)
+    {
+        if (!valid(handle))
+            return;
+        size_t index = indexOf[handle];
+        size_t count = subtree[index];
+        for (unsigned int ancestor = parentOf[index]; ancestor != NONE; ancestor = parentOf[indexOf[ancestor]])
+            subtree[indexOf[ancestor]] -= (unsigned int)count;
+        for (size_t i = index; i < index + count; i++)
+        {
+            indexOf[handleOf[i]] = NONE;
+            freeHandles.push_back(handleOf[i]);
+        }
+
+        handleOf.erase(handleOf.begin() + index, handleOf.begin() + index + count);
+        parentOf.erase(parentOf.begin() + index, parentOf.begin() + index + count);
+        subtree.erase(subtree.begin() + index, subtree.begin() + index + count);
+        dirty.erase(dirty.begin() + index, dirty.begin() + index + count);
+        localMatrices.erase(localMatrices.begin() + index * 16, localMatrices.begin() + (index + count) * 16);
+        worldMatrices.erase(worldMatrices.begin() + index * 16, worldMatrices.begin() + (index + count) * 16);
+        reindex(index);
+        // roots that went with the subtree are skipped by update()
+    }
+    // ------------------------------------------------------------------------
+    void setLocal(unsigned int handle, const float* matrix)
+    {
+        if (!valid(handle))
+            return;
+        size_t index = indexOf[handle];
+        std::memcpy(&localMatrices[index * 16], matrix, 16 * sizeof(float));
+        if (!dirty[index])
+        {
+            dirty[index] = 1;
+            dirtyRoots.push_back(handle);
+        }
+    }
+    const float* local(unsigned int handle) const
+    {
+        return valid(handle) ? &localMatrices[indexOf[handle] * 16] : NULL;
+    }
+    // as of the last update()
+    const float* world(unsigned int handle) const
+    {
+        return valid(handle) ? &worldMatrices[indexOf[handle] * 16] : NULL;
+    }
+    // ------------------------------------------------------------------------
+    bool valid(unsigned int handle) const
+    {
+        return handle < indexOf.size() && indexOf[handle] != NONE;
+    }
+    unsigned int parent(unsigned int handle) const
+    {
+        if (!valid(handle))
+            return NONE;
+        return parentOf[indexOf[handle]];
+    }
+    // position in worlds(), changes when nodes are added or removed before it
+    unsigned int index(unsigned int handle) const
+    {
+        if (!valid(handle))
+            return NONE;
+        return indexOf[handle];
+    }
+    size_t size() const
+    {
+        return handleOf.size();
+    }
+    const float* worlds() const
+    {
+        return worldMatrices.empty() ? NULL : worldMatrices.data();
+    }
+    const Stats& stats() const
+    {
+        return stat;
+    }
+    // recomputes the subtrees under every node set since the last update.
+    // sorted by position, a root inside a range already walked is skipped
+    // ------------------------------------------------------------------------
+    size_t update()
+    {
+        stat = Stats();
+        std::vector<unsigned int>& roots = dirtyRoots;
+        for (unsigned int& root : roots)
+        {
+            if (valid(root))
+                root = indexOf[root];
+            else
+                root = NONE;
+        }
+        std::sort(roots.begin(), roots.end());
+
+        size_t covered = 0;
+        for (unsigned int root : roots)
+        {
+            if (root == NONE)
+                break;
+            if (root < covered)
+                continue;
+            covered = root + subtree[root];
+            recompute(root, covered);
+            stat.subtrees++;
+        }
+        roots.clear();
+        return stat.updated;
+    }
+    // every node, one pass in array order. what update() costs when
+    // everything moved, without the sort
+    // ------------------------------------------------------------------------
+    size_t updateAll()
+    {
+        stat = Stats();
+        dirtyRoots.clear();
+        recompute(0, handleOf.size());
+        stat.subtrees = handleOf.empty() ? 0 : 1;
+        return stat.updated;
+    }
+    // ------------------------------------------------------------------------
+    void clear()
+    {
+        handleOf.clear();
+        parentOf.clear();
+        subtree.clear();
+        dirty.clear();
+        localMatrices.clear();
+        worldMatrices.clear();
+        indexOf.clear();
+        freeHandles.clear();
+        dirtyRoots.clear();
+    }
+
+    // out = a * b, column-major, out must not alias a or b
+    // ------------------------------------------------------------------------
+    static void multiply(const float* a, const float* b, float* out)
+    {
+        for (int column = 0; column < 4; column++)
+        {
+            const float* bc = b + column * 4;
+            for (int row = 0; row < 4; row++)
+                out[column * 4 + row] = a[row] * bc[0] + a[4 + row] * bc[1] + a[8 + row] * bc[2] + a[12 + row] * bc[3];
+        }
+    }
+
+private:
+    // per position in the array
+    std::vector<unsigned int> handleOf;
+    std::vector<unsigned int> parentOf;   // handle, NONE for roots
+    std::vector<unsigned int> subtree;    // nodes in the subtree, itself included
+    std::vector<unsigned char> dirty;
+    std::vector<float> localMatrices;
+    std::vector<float> worldMatrices;
+    // per handle
+    std::vector<unsigned int> indexOf;
+    std::vector<unsigned int> freeHandles;
+    std::vector<unsigned int> dirtyRoots;
+    Stats stat;
+
+    // positions from index on moved
+    // ------------------------------------------------------------------------
+    void reindex(size_t index)
+    {
+        for (size_t i = index; i < handleOf.size(); i++)
+            indexOf[handleOf[i]] = (unsigned int)i;
+    }
+    // [begin, end) in order, each parent's world is final before its children
+    // ------------------------------------------------------------------------
+    void recompute(size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            unsigned int parent = parentOf[i];
+            if (parent == NONE)
+                std::memcpy(&worldMatrices[i * 16], &localMatrices[i * 16], 16 * sizeof(float));
+            else
+                multiply(&worldMatrices[indexOf[parent] * 16], &localMatrices[i * 16], &worldMatrices[i * 16]);
+            dirty[i] = 0;
+        }
+        stat.updated += end - begin;
+    }
+};
+
+#endif /* TransformHierarchy_h */
@@ -0,0 +1,205 @@
+//
+//  MeshFile.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef MeshFile_h
+#define MeshFile_h
+
+#include <glad/glad.h>
+
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "MappedFile.h"
+#include "VertexLayout.h"
+#include "GLState.h"
+
+// binary mesh container, written by Tools/meshconv.cpp:
+//
+//   MeshFileHeader
+//   vertex blob   vertexCount * layout stride bytes, already in GPU format
+//   index blob    indexCount 16 or 32-bit indices
+//
+// both blobs start on a BLOB_ALIGNMENT boundary. the file is only ever
+// memory mapped, the blobs go to glBufferData as they are.
+struct MeshFileHeader
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int vertexCount;
+    unsigned int indexCount;
+    unsigned int indexType;     // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    unsigned int elementCount;
+    VertexElement elements[VertexLayout::MAX_ELEMENTS];
+    float boundsMin[3];
+    float boundsMax[3];
+    unsigned long long vertexOffset;
+    unsigned long long vertexBytes;
+    unsigned long long indexOffset;
+    unsigned long long indexBytes;
+};
+static_assert(sizeof(MeshFileHeader) == 176, "MeshFileHeader is an on-disk format");
+
+// ------------------------------------------------------------------------
+class MeshFile
+{
+public:
+    static const unsigned int MAGIC = 0x3148534D;  // "MSH1"
+    static const unsigned int VERSION = 1;
+    static const unsigned int BLOB_ALIGNMENT = 64;
+    // attribute locations every GL 3.3 context has
+    static const unsigned int MAX_LOCATIONS = 16;
+
+    // map and validate, nothing is read beyond the header
+    // ------------------------------------------------------------------------
+    bool open(const char* path)
+    {
+        if (!file.open(path))
+        {
+            std::cout << "ERROR::MESH::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+            return false;
+        }
+        if (!valid())
+        {
+            std::cout << "ERROR::MESH::INVALID_FILE " << path << std::endl;
+            file.close();
+            return false;
+        }
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    const MeshFileHeader& header() const
+    {
+        return *(const MeshFileHeader*)file.data();
+    }
+    VertexLayout layout() const
+    {
+        return VertexLayout(header().elements, header().elementCount);
+    }
+    const void* vertexData() const
+    {
+        return file.data() + header().vertexOffset;
+    }
+    const void* indexData() const
+    {
+        return file.data() + header().indexOffset;
+    }
+    // fill VBO and EBO straight from the mapping and point VAO at them. the
+    // pages are read once, by the driver, while it copies them.
+    // ------------------------------------------------------------------------
+    void upload(unsigned int VAO, unsigned int VBO, unsigned int EBO) const
+    {
+        const MeshFileHeader& h = header();
+        glstate().bindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, h.vertexBytes, vertexData(), GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, h.indexBytes, indexData(), GL_STATIC_DRAW);
+
+        layout().apply();
+
+        // unbind VBO
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // unbind VAO
+        glstate().bindVertexArray(0);
+    }
+    // vertices are in layout's format already. written to a temp file and
+    // renamed, a crash never leaves a half written mesh behind.
+    // ------------------------------------------------------------------------
+    static bool write(const char* path, const VertexLayout& layout, const void* vertices, size_t vertexCount,
+                      GLenum indexType, const void* indices, size_t indexCount,
+                      const float boundsMin[3], const float boundsMax[3])
+    {
+        MeshFileHeader h = {};
+        h.magic = MAGIC;
+        h.version = VERSION;
+        h.vertexCount = (unsigned int)vertexCount;
+        h.indexCount = (unsigned int)indexCount;
+        h.indexType = indexType;
+        h.elementCount = layout.elementCount();
+        for (unsigned int i = 0; i < layout.elementCount(); i++)
+            h.elements[i] = layout.element(i);
+        memcpy(h.boundsMin, boundsMin, sizeof(h.boundsMin));
+        memcpy(h.boundsMax, boundsMax, sizeof(h.boundsMax));
+        h.vertexOffset = align(sizeof(h));
+        h.vertexBytes = (unsigned long long)vertexCount * layout.stride();
+        h.indexOffset = align(h.vertexOffset + h.vertexBytes);
+        h.indexBytes = (unsigned long long)indexCount * (indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+
+        std::string temp = std::string(path) + ".tmp";
+        FILE* out = fopen(temp.c_str(), "wb");
+        if (!out)
+        {
+            std::cout << "ERROR::MESH::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        bool ok = fwrite(&h, sizeof(h), 1, out) == 1
+            && pad(out, h.vertexOffset - sizeof(h))
+            && fwrite(vertices, 1, h.vertexBytes, out) == h.vertexBytes
+            && pad(out, h.indexOffset - h.vertexOffset - h.vertexBytes)
+            && fwrite(indices, 1, h.indexBytes, out) == h.indexBytes;
+        ok = fclose(out) == 0 && ok;
+        if (!ok || rename(temp.c_str(), path) != 0)
+        {
+            remove(temp.c_str());
+            std::cout << "ERROR::MESH::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    MappedFile file;
+
+    // everything the accessors rely on, so a truncated or foreign file is
+    // rejected before any pointer into it is handed out
+    // ------------------------------------------------------------------------
+    bool valid() const
+    {
+        if (file.size() < sizeof(MeshFileHeader))
+            return false;
+        const MeshFileHeader& h = header();
+        if (h.magic != MAGIC || h.version != VERSION || h.elementCount > VertexLayout::MAX_ELEMENTS)
+            return false;
+        if (h.indexType != GL_UNSIGNED_SHORT && h.indexType != GL_UNSIGNED_INT)
+            return false;
+        // an unknown format has no size and would reach glVertexAttribPointer
+        for (unsigned int i = 0; i < h.elementCount; i++)
+        {
+            if (vertexFormatInfo(h.elements[i].format).bytes == 0 || h.elements[i].location >= MAX_LOCATIONS)
+                return false;
+        }
+        unsigned long long indexSize = h.indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+        if (h.vertexBytes != (unsigned long long)h.vertexCount * layout().stride()
+            || h.indexBytes != (unsigned long long)h.indexCount * indexSize)
+            return false;
+        if (h.vertexOffset % BLOB_ALIGNMENT != 0 || h.indexOffset % BLOB_ALIGNMENT != 0)
+            return false;
+        // offset + bytes could wrap, compare against what is left instead
+        unsigned long long size = file.size();
+        return h.vertexOffset >= sizeof(MeshFileHeader)
+            && h.vertexOffset <= size && h.vertexBytes <= size - h.vertexOffset
+            && h.indexOffset >= h.vertexOffset + h.vertexBytes
+            && h.indexOffset <= size && h.indexBytes <= size - h.indexOffset;
+    }
+    // ------------------------------------------------------------------------
+    static unsigned long long align(unsigned long long offset)
+    {
+        return (offset + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+    }
+    static bool pad(FILE* out, unsigned long long bytes)
+    {
+        static const char zeros[BLOB_ALIGNMENT] = {};
+        return bytes == 0 || fwrite(zeros, 1, bytes, out) == bytes;
+    }
+};
+
+#endif /* MeshFile_h */
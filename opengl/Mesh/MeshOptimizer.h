@@ -0,0 +1,290 @@
+//
+//  MeshOptimizer.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef MeshOptimizer_h
+#define MeshOptimizer_h
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <cstring>
+#include <iostream>
+
+#include "Hash.h"
+
+// interleaved float vertices plus an index buffer
+struct IndexedMesh
+{
+    std::vector<float> vertices;
+    unsigned int stride = 0;              // floats per vertex
+    std::vector<unsigned int> indices;
+    std::vector<unsigned short> indices16;  // same indices, filled when they fit
+
+    size_t vertexCount() const
+    {
+        return stride ? vertices.size() / stride : 0;
+    }
+    // GL_UNSIGNED_SHORT whenever every index fits, half the index bandwidth
+    GLenum indexType() const
+    {
+        return !indices16.empty() || indices.empty() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+    const void* indexData() const
+    {
+        return indexType() == GL_UNSIGNED_SHORT ? (const void*)indices16.data() : (const void*)indices.data();
+    }
+    size_t indexDataSize() const
+    {
+        return indexType() == GL_UNSIGNED_SHORT ? indices16.size() * sizeof(unsigned short) : indices.size() * sizeof(unsigned int);
+    }
+};
+
+// turns unindexed triangle soup into an indexed mesh that is cheap to draw:
+//
+//   1. weld     vertices with identical bytes become one vertex
+//   2. tipsify  triangles reordered for the post-transform vertex cache
+//               (Sander, Nehab, Barczak 2007), linear time
+//   3. fetch    vertices renumbered in first-use order so the vertex fetch
+//               walks memory forward
+//   4. pack     16-bit indices when the vertex count allows
+//
+// Report carries the ACMR (cache misses per triangle, 0.5 is ideal for big
+// regular grids, 3 means nothing is reused) before and after step 2.
+//
+//   MeshOptimizer::Report report;
+//   IndexedMesh mesh = MeshOptimizer::optimize(vertices, 36, 5, &report);
+class MeshOptimizer
+{
+public:
+    struct Report
+    {
+        size_t inputVertices = 0;
+        size_t outputVertices = 0;
+        size_t triangles = 0;
+        float acmrBefore = 0.0f;  // welded, original triangle order
+        float acmrAfter = 0.0f;
+    };
+
+    // simulated cache, about what current GPUs reuse per batch
+    static const unsigned int CACHE_SIZE = 16;
+
+    // a trailing partial triangle is reported and dropped
+    // ------------------------------------------------------------------------
+    static IndexedMesh optimize(const float* vertices, size_t vertexCount, unsigned int stride, Report* report = NULL)
+    {
+        if (vertexCount % 3)
+        {
+            std::cout << "ERROR::MESH_OPTIMIZER::PARTIAL_TRIANGLE " << vertexCount << std::endl;
+            vertexCount -= vertexCount % 3;
+        }
+        IndexedMesh mesh;
+        weld(vertices, vertexCount, stride, mesh);
+        if (report)
+        {
+            report->inputVertices = vertexCount;
+            report->triangles = mesh.indices.size() / 3;
+            report->acmrBefore = acmr(mesh.indices, mesh.vertexCount());
+        }
+
+        mesh.indices = tipsify(mesh.indices, mesh.vertexCount(), CACHE_SIZE);
+        optimizeVertexFetch(mesh);
+        pack(mesh);
+
+        if (report)
+        {
+            report->outputVertices = mesh.vertexCount();
+            report->acmrAfter = acmr(mesh.indices, mesh.vertexCount());
+        }
+        return mesh;
+    }
+    // merge bitwise identical vertices. -0.0 and 0.0 stay apart, which only
+    // costs a vertex and never merges things that should differ.
+    // ------------------------------------------------------------------------
+    static void weld(const float* vertices, size_t vertexCount, unsigned int stride, IndexedMesh& out)
+    {
+        const size_t bytes = stride * sizeof(float);
+        out.stride = stride;
+        out.vertices.clear();
+        out.indices.clear();
+        out.indices.reserve(vertexCount);
+
+        // open addressing over output vertex indices, at most half full
+        size_t buckets = 16;
+        while (buckets < vertexCount * 2)
+            buckets *= 2;
+        const unsigned int empty = EMPTY;
+        std::vector<unsigned int> table(buckets, empty);
+
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const float* vertex = vertices + i * stride;
+            size_t bucket = fnv1a((const char*)vertex, bytes) & (buckets - 1);
+            while (table[bucket] != empty
+                   && memcmp(&out.vertices[table[bucket] * stride], vertex, bytes) != 0)
+                bucket = (bucket + 1) & (buckets - 1);
+
+            if (table[bucket] == empty)
+            {
+                table[bucket] = (unsigned int)(out.vertices.size() / stride);
+                out.vertices.insert(out.vertices.end(), vertex, vertex + stride);
+            }
+            out.indices.push_back(table[bucket]);
+        }
+    }
+    // average transformed vertices per triangle with a FIFO cache of cacheSize
+    // ------------------------------------------------------------------------
+    static float acmr(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = CACHE_SIZE)
+    {
+        if (indices.size() < 3)
+            return 0.0f;
+        // a vertex is cached while fewer than cacheSize misses happened since
+        // it was loaded, which is exactly FIFO replacement
+        std::vector<unsigned int> loaded(vertexCount, 0);
+        unsigned int misses = 0;
+        for (unsigned int index : indices)
+        {
+            if (loaded[index] == 0 || misses - loaded[index] >= cacheSize)
+            {
+                misses++;
+                loaded[index] = misses;
+            }
+        }
+        return (float)misses / (indices.size() / 3);
+    }
+    // tipsify: fan around the vertex that was loaded most recently and still
+    // has triangles left, so the cache mostly holds vertices about to be reused.
+    // returns the reordered index list, indices past the last whole triangle
+    // are ignored.
+    // ------------------------------------------------------------------------
+    static std::vector<unsigned int> tipsify(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize)
+    {
+        size_t triangleCount = indices.size() / 3;
+        std::vector<unsigned int> out;
+        out.reserve(indices.size());
+
+        // vertex -> adjacent triangles, as offsets into one array
+        // a vertex of a partial triangle would stay live forever
+        std::vector<unsigned int> live(vertexCount, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+            live[indices[i]]++;
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] = offsets[v] + live[v];
+        std::vector<unsigned int> adjacency(triangleCount * 3);
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            for (int corner = 0; corner < 3; corner++)
+                adjacency[fill[indices[t * 3 + corner]]++] = (unsigned int)t;
+        }
+
+        std::vector<unsigned int> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<unsigned int> deadEnd;
+        std::vector<unsigned int> candidates;
+        unsigned int time = cacheSize + 1;
+        size_t cursor = 0;
+
+        long fan = vertexCount ? 0 : -1;
+        while (fan >= 0)
+        {
+            candidates.clear();
+            for (unsigned int a = offsets[fan]; a < offsets[fan + 1]; a++)
+            {
+                unsigned int t = adjacency[a];
+                if (emitted[t])
+                    continue;
+                for (int corner = 0; corner < 3; corner++)
+                {
+                    unsigned int v = indices[t * 3 + corner];
+                    out.push_back(v);
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (time - cacheTime[v] > cacheSize)
+                        cacheTime[v] = time++;
+                }
+                emitted[t] = true;
+            }
+
+            // next fan: the candidate that stays in the cache longest while its
+            // remaining triangles are emitted, otherwise a dead-end vertex
+            fan = -1;
+            long best = -1;
+            for (unsigned int v : candidates)
+            {
+                if (live[v] == 0)
+                    continue;
+                long priority = 0;
+                if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+                    priority = time - cacheTime[v];
+                if (priority > best)
+                {
+                    best = priority;
+                    fan = v;
+                }
+            }
+            if (fan < 0)
+                fan = skipDeadEnd(live, deadEnd, cursor);
+        }
+        return out;
+    }
+    // renumber vertices in the order the index buffer first touches them,
+    // unreferenced vertices are dropped
+    // ------------------------------------------------------------------------
+    static void optimizeVertexFetch(IndexedMesh& mesh)
+    {
+        size_t vertexCount = mesh.vertexCount();
+        const unsigned int empty = EMPTY;
+        std::vector<unsigned int> remap(vertexCount, empty);
+        std::vector<float> vertices;
+        vertices.reserve(mesh.vertices.size());
+        unsigned int next = 0;
+        for (unsigned int& index : mesh.indices)
+        {
+            if (remap[index] == empty)
+            {
+                remap[index] = next++;
+                const float* vertex = &mesh.vertices[index * mesh.stride];
+                vertices.insert(vertices.end(), vertex, vertex + mesh.stride);
+            }
+            index = remap[index];
+        }
+        mesh.vertices.swap(vertices);
+    }
+    // ------------------------------------------------------------------------
+    static void pack(IndexedMesh& mesh)
+    {
+        mesh.indices16.clear();
+        if (mesh.vertexCount() > 0xFFFF + 1)
+            return;
+        mesh.indices16.assign(mesh.indices.begin(), mesh.indices.end());
+    }
+
+private:
+    static const unsigned int EMPTY = 0xFFFFFFFF;
+
+    // ------------------------------------------------------------------------
+    static long skipDeadEnd(const std::vector<unsigned int>& live, std::vector<unsigned int>& deadEnd, size_t& cursor)
+    {
+        while (!deadEnd.empty())
+        {
+            unsigned int v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0)
+                return v;
+        }
+        for (; cursor < live.size(); cursor++)
+        {
+            if (live[cursor] > 0)
+                return (long)cursor;
+        }
+        return -1;
+    }
+};
+
+#endif /* MeshOptimizer_h */
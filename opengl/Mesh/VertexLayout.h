@@ -0,0 +1,250 @@
+//
+//  VertexLayout.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef VertexLayout_h
+#define VertexLayout_h
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <cstring>
+#include <initializer_list>
+
+// storage of one attribute. the packed formats trade precision for bandwidth:
+// a float3 position + float2 uv is 20 bytes, HALF4 + UNORM16_2 is 12.
+enum class VertexFormat
+{
+    FLOAT1,
+    FLOAT2,
+    FLOAT3,
+    FLOAT4,
+    HALF2,             // 16-bit floats
+    HALF4,             // positions, w is 1. there is no HALF3, 6 bytes breaks alignment
+    UNORM16_2,         // 0..1 in 16 bits, texture coordinates
+    UNORM8_4,          // 0..1 in 8 bits, RGBA8 colors
+    SNORM_2_10_10_10,  // -1..1, xyz 10 bits and w 2 bits, normals and tangents
+};
+
+struct VertexFormatInfo
+{
+    int components;
+    GLenum type;
+    bool normalized;
+    unsigned int bytes;
+};
+
+constexpr VertexFormatInfo vertexFormatInfo(VertexFormat format)
+{
+    switch (format)
+    {
+        case VertexFormat::FLOAT1:           return { 1, GL_FLOAT, false, 4 };
+        case VertexFormat::FLOAT2:           return { 2, GL_FLOAT, false, 8 };
+        case VertexFormat::FLOAT3:           return { 3, GL_FLOAT, false, 12 };
+        case VertexFormat::FLOAT4:           return { 4, GL_FLOAT, false, 16 };
+        case VertexFormat::HALF2:            return { 2, GL_HALF_FLOAT, false, 4 };
+        case VertexFormat::HALF4:            return { 4, GL_HALF_FLOAT, false, 8 };
+        case VertexFormat::UNORM16_2:        return { 2, GL_UNSIGNED_SHORT, true, 4 };
+        case VertexFormat::UNORM8_4:         return { 4, GL_UNSIGNED_BYTE, true, 4 };
+        case VertexFormat::SNORM_2_10_10_10: return { 4, GL_INT_2_10_10_10_REV, true, 4 };
+    }
+    return { 0, GL_FLOAT, false, 0 };
+}
+
+struct VertexElement
+{
+    unsigned int location = 0;
+    VertexFormat format = VertexFormat::FLOAT1;
+    unsigned int offset = 0;  // filled in by VertexLayout
+};
+
+// interleaved vertex description, offsets and stride follow from the element
+// order. usable at compile time:
+//
+//   constexpr VertexLayout POSITION_UV = { { 0, VertexFormat::FLOAT3 }, { 2, VertexFormat::FLOAT2 } };
+//   static_assert(POSITION_UV.stride() == 20, "");
+//   POSITION_UV.apply();  // with the VAO and VBO bound
+class VertexLayout
+{
+public:
+    static const unsigned int MAX_ELEMENTS = 8;
+
+    constexpr VertexLayout(std::initializer_list<VertexElement> list)
+        : elements{}, count(0), size(0)
+    {
+        for (const VertexElement& element : list)
+        {
+            if (count == MAX_ELEMENTS)
+                break;
+            elements[count].location = element.location;
+            elements[count].format = element.format;
+            elements[count].offset = size;
+            size += vertexFormatInfo(element.format).bytes;
+            count++;
+        }
+    }
+
+    // rebuild from stored elements, offsets are derived again
+    constexpr VertexLayout(const VertexElement* list, unsigned int listCount)
+        : elements{}, count(0), size(0)
+    {
+        for (unsigned int i = 0; i < listCount && i < MAX_ELEMENTS; i++)
+        {
+            elements[count].location = list[i].location;
+            elements[count].format = list[i].format;
+            elements[count].offset = size;
+            size += vertexFormatInfo(list[i].format).bytes;
+            count++;
+        }
+    }
+
+    constexpr unsigned int stride() const
+    {
+        return size;
+    }
+    constexpr unsigned int elementCount() const
+    {
+        return count;
+    }
+    constexpr const VertexElement& element(unsigned int i) const
+    {
+        return elements[i];
+    }
+    // attribute pointers of the bound VAO into the bound GL_ARRAY_BUFFER,
+    // vertex 0 starting at baseOffset bytes
+    // ------------------------------------------------------------------------
+    void apply(size_t baseOffset = 0) const
+    {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const VertexElement& e = elements[i];
+            VertexFormatInfo info = vertexFormatInfo(e.format);
+            glVertexAttribPointer(e.location, info.components, info.type, info.normalized ? GL_TRUE : GL_FALSE,
+                                  size, (void*)(baseOffset + e.offset));
+            glEnableVertexAttribArray(e.location);
+        }
+    }
+    // convert vertexCount vertices stored as from, which has to be all FLOATn
+    // formats, into this layout. elements are matched by location, missing
+    // components read as 0 (w as 1).
+    // ------------------------------------------------------------------------
+    void pack(const float* vertices, size_t vertexCount, const VertexLayout& from, std::vector<unsigned char>& out) const
+    {
+        out.assign(vertexCount * size, 0);
+        const size_t sourceStride = from.stride() / sizeof(float);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            const float* source = vertices + v * sourceStride;
+            unsigned char* target = &out[v * size];
+            for (unsigned int i = 0; i < count; i++)
+            {
+                float value[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                for (unsigned int j = 0; j < from.count; j++)
+                {
+                    if (from.elements[j].location != elements[i].location)
+                        continue;
+                    int components = vertexFormatInfo(from.elements[j].format).components;
+                    memcpy(value, source + from.elements[j].offset / sizeof(float), components * sizeof(float));
+                }
+                packElement(elements[i].format, value, target + elements[i].offset);
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    static unsigned short toHalf(float value)
+    {
+        unsigned int bits;
+        memcpy(&bits, &value, sizeof(bits));
+        unsigned int sign = (bits >> 16) & 0x8000;
+        unsigned int rawExponent = (bits >> 23) & 0xFF;
+        unsigned int mantissa = bits & 0x7FFFFF;
+        int exponent = (int)rawExponent - 127 + 15;
+
+        if (rawExponent == 0xFF)
+            return (unsigned short)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+        if (exponent >= 31)
+            return (unsigned short)(sign | 0x7C00);
+        if (exponent <= 0)
+        {
+            // subnormal half, or zero when even that is too small
+            if (exponent < -10)
+                return (unsigned short)sign;
+            mantissa |= 0x800000;
+            unsigned int shift = 14 - exponent;
+            unsigned int half = mantissa >> shift;
+            if ((mantissa >> (shift - 1)) & 1)
+                half++;
+            return (unsigned short)(sign | half);
+        }
+        // a rounding carry into the exponent is still the right answer
+        unsigned int half = sign | (exponent << 10) | (mantissa >> 13);
+        if (mantissa & 0x1000)
+            half++;
+        return (unsigned short)half;
+    }
+    static unsigned int toUNorm(float value, unsigned int max)
+    {
+        value = value < 0.0f ? 0.0f : value > 1.0f ? 1.0f : value;
+        return (unsigned int)(value * max + 0.5f);
+    }
+    static int toSNorm(float value, int max)
+    {
+        value = value < -1.0f ? -1.0f : value > 1.0f ? 1.0f : value;
+        return (int)(value * max + (value < 0.0f ? -0.5f : 0.5f));
+    }
+
+private:
+    VertexElement elements[MAX_ELEMENTS];
+    unsigned int count;
+    unsigned int size;
+
+    // ------------------------------------------------------------------------
+    static void packElement(VertexFormat format, const float* value, unsigned char* target)
+    {
+        switch (format)
+        {
+            case VertexFormat::FLOAT1:
+            case VertexFormat::FLOAT2:
+            case VertexFormat::FLOAT3:
+            case VertexFormat::FLOAT4:
+                memcpy(target, value, vertexFormatInfo(format).bytes);
+                break;
+            case VertexFormat::HALF2:
+            case VertexFormat::HALF4:
+            {
+                unsigned short half[4];
+                for (int c = 0; c < 4; c++)
+                    half[c] = toHalf(value[c]);
+                memcpy(target, half, vertexFormatInfo(format).bytes);
+                break;
+            }
+            case VertexFormat::UNORM16_2:
+            {
+                unsigned short unorm[2] = { (unsigned short)toUNorm(value[0], 0xFFFF), (unsigned short)toUNorm(value[1], 0xFFFF) };
+                memcpy(target, unorm, sizeof(unorm));
+                break;
+            }
+            case VertexFormat::UNORM8_4:
+            {
+                for (int c = 0; c < 4; c++)
+                    target[c] = (unsigned char)toUNorm(value[c], 0xFF);
+                break;
+            }
+            case VertexFormat::SNORM_2_10_10_10:
+            {
+                unsigned int packed = (toSNorm(value[0], 511) & 0x3FF)
+                    | (toSNorm(value[1], 511) & 0x3FF) << 10
+                    | (toSNorm(value[2], 511) & 0x3FF) << 20
+                    | (unsigned int)(toSNorm(value[3], 1) & 0x3) << 30;
+                memcpy(target, &packed, sizeof(packed));
+                break;
+            }
+        }
+    }
+};
+
+#endif /* VertexLayout_h */
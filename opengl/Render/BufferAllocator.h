@@ -0,0 +1,154 @@
+//
+//  BufferAllocator.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef BufferAllocator_h
+#define BufferAllocator_h
+
+#include <set>
+#include <unordered_map>
+
+// buddy allocator over offsets into one big buffer. it never touches memory,
+// sizes and offsets are in whatever unit the caller picks (vertices, indices).
+// a block of 2^k units splits into two buddies of 2^(k-1), and a freed block
+// merges with its buddy whenever that one is free too, so allocate and free
+// are O(log capacity). requests round up to a power of two.
+//
+//   BufferAllocator vertices(65536);
+//   unsigned int first = vertices.allocate(24);  // 32 units reserved
+//   vertices.free(first);
+class BufferAllocator
+{
+public:
+    static const unsigned int INVALID = 0xFFFFFFFF;
+
+    // capacity rounds up to a power of two
+    BufferAllocator(unsigned int capacity = 0)
+        : top(0), total(0), usedUnits(0)
+    {
+        if (capacity)
+            grow(capacity);
+    }
+    // offset of a block of at least size units, INVALID when nothing fits.
+    // the lowest free offset is handed out first, which keeps live blocks
+    // packed towards the start of the buffer.
+    // ------------------------------------------------------------------------
+    unsigned int allocate(unsigned int size)
+    {
+        unsigned int order = orderOf(size);
+        unsigned int k = order;
+        while (k <= top && (total == 0 || freeLists[k].empty()))
+            k++;
+        if (total == 0 || k > top)
+            return INVALID;
+
+        unsigned int offset = *freeLists[k].begin();
+        freeLists[k].erase(freeLists[k].begin());
+        // keep the lower half, the upper one becomes free
+        while (k > order)
+        {
+            k--;
+            freeLists[k].insert(offset + (1u << k));
+        }
+        allocated[offset] = order;
+        usedUnits += 1u << order;
+        return offset;
+    }
+    // ------------------------------------------------------------------------
+    void free(unsigned int offset)
+    {
+        auto found = allocated.find(offset);
+        if (found == allocated.end())
+            return;
+        unsigned int order = found->second;
+        allocated.erase(found);
+        usedUnits -= 1u << order;
+        release(offset, order);
+    }
+    // units actually reserved for the block at offset, 0 when not allocated
+    // ------------------------------------------------------------------------
+    unsigned int size(unsigned int offset) const
+    {
+        auto found = allocated.find(offset);
+        return found == allocated.end() ? 0 : 1u << found->second;
+    }
+    // double until capacity fits. live blocks keep their offsets, the buffer
+    // behind them only has to grow at the end.
+    // ------------------------------------------------------------------------
+    void grow(unsigned int capacity)
+    {
+        if (total == 0)
+        {
+            top = orderOf(capacity);
+            total = 1u << top;
+            freeLists[top].insert(0);
+            return;
+        }
+        while (total < capacity && top + 1 < MAX_ORDERS)
+        {
+            // the new upper half is the buddy of the whole old range
+            top++;
+            release(total, top - 1);
+            total <<= 1;
+        }
+    }
+    // ------------------------------------------------------------------------
+    unsigned int capacity() const
+    {
+        return total;
+    }
+    unsigned int used() const
+    {
+        return usedUnits;
+    }
+    unsigned int largestFree() const
+    {
+        for (int k = (int)top; k >= 0 && total; k--)
+        {
+            if (!freeLists[k].empty())
+                return 1u << k;
+        }
+        return 0;
+    }
+    // smallest power of two that holds size units
+    static unsigned int roundUp(unsigned int size)
+    {
+        return 1u << orderOf(size);
+    }
+
+private:
+    static const unsigned int MAX_ORDERS = 32;
+
+    // free block offsets per order, ordered so allocate takes the lowest
+    std::set<unsigned int> freeLists[MAX_ORDERS];
+    std::unordered_map<unsigned int, unsigned int> allocated;  // offset -> order
+    unsigned int top;
+    unsigned int total;
+    unsigned int usedUnits;
+
+    // ------------------------------------------------------------------------
+    void release(unsigned int offset, unsigned int order)
+    {
+        while (order < top)
+        {
+            unsigned int buddy = offset ^ (1u << order);
+            if (freeLists[order].erase(buddy) == 0)
+                break;
+            offset = offset < buddy ? offset : buddy;
+            order++;
+        }
+        freeLists[order].insert(offset);
+    }
+    static unsigned int orderOf(unsigned int size)
+    {
+        unsigned int order = 0;
+        while (order + 1 < MAX_ORDERS && (1u << order) < size)
+            order++;
+        return order;
+    }
+};
+
+#endif /* BufferAllocator_h */
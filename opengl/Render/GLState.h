@@ -0,0 +1,208 @@
+//
+//  GLState.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef GLState_h
+#define GLState_h
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+#include "GLExtensions.h"
+
+// shadow copy of the bindings the demos change all the time. a bind that
+// matches what is already current never reaches the driver. only works while
+// every bind goes through here, code that calls GL directly has to call
+// invalidate() afterwards. debug builds compare the copy with glGet* before
+// trusting it and report any drift.
+//
+//   glstate().useProgram(shader.ID);
+//   glstate().bindVertexArray(VAO);
+//   glstate().bindTexture(0, GL_TEXTURE_2D, texture);
+class GLState
+{
+public:
+    struct Stats
+    {
+        unsigned int issued = 0;
+        unsigned int elided = 0;
+
+        void reset()
+        {
+            issued = elided = 0;
+        }
+    };
+
+    static const unsigned int MAX_UNITS = 16;
+
+    GLState()
+    {
+        invalidate();
+    }
+    // ------------------------------------------------------------------------
+    void useProgram(unsigned int id)
+    {
+#ifdef DEBUG
+        verify(GL_CURRENT_PROGRAM, program, "program");
+#endif
+        if (!changed(program, id))
+            return;
+        glUseProgram(id);
+    }
+    // a current program overrides the pipeline, so this also unbinds the program
+    // ------------------------------------------------------------------------
+    void bindProgramPipeline(unsigned int id)
+    {
+        useProgram(0);
+        if (!changed(pipeline, id))
+            return;
+        glext().BindProgramPipeline(id);
+    }
+    // ------------------------------------------------------------------------
+    void bindVertexArray(unsigned int id)
+    {
+#ifdef DEBUG
+        verify(GL_VERTEX_ARRAY_BINDING, vertexArray, "vertex array");
+#endif
+        if (!changed(vertexArray, id))
+            return;
+        glBindVertexArray(id);
+    }
+    // ------------------------------------------------------------------------
+    void activeTexture(unsigned int unit)
+    {
+#ifdef DEBUG
+        int real = 0;
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &real);
+        if (activeUnit != UNKNOWN && (unsigned int)real != GL_TEXTURE0 + activeUnit)
+            std::cout << "ERROR::GLSTATE::OUT_OF_SYNC active texture cached=" << activeUnit << " real=" << real - GL_TEXTURE0 << std::endl;
+#endif
+        if (!changed(activeUnit, unit))
+            return;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    // leaves unit active either way, so glTexImage2D and friends that follow
+    // still hit this texture
+    // ------------------------------------------------------------------------
+    void bindTexture(unsigned int unit, GLenum target, unsigned int id)
+    {
+        activeTexture(unit);
+        int slot = targetSlot(target);
+        if (unit >= MAX_UNITS || slot < 0)
+        {
+            glBindTexture(target, id);
+            return;
+        }
+#ifdef DEBUG
+        if (textures[unit][slot] != UNKNOWN)
+        {
+            int real = 0;
+            glGetIntegerv(bindingQuery(target), &real);
+            if ((unsigned int)real != textures[unit][slot])
+                std::cout << "ERROR::GLSTATE::OUT_OF_SYNC texture unit " << unit << " cached=" << textures[unit][slot] << " real=" << real << std::endl;
+        }
+#endif
+        if (textures[unit][slot] == id)
+        {
+            stat.elided++;
+            return;
+        }
+        glBindTexture(target, id);
+        textures[unit][slot] = id;
+        stat.issued++;
+    }
+    // ------------------------------------------------------------------------
+    unsigned int currentProgram() const
+    {
+        return program;
+    }
+    // forget everything, the next bind of each kind always reaches GL. call after
+    // code that binds behind the cache's back, or after deleting bound objects.
+    // ------------------------------------------------------------------------
+    void invalidate()
+    {
+        program = pipeline = vertexArray = activeUnit = UNKNOWN;
+        for (unsigned int unit = 0; unit < MAX_UNITS; unit++)
+        {
+            for (int slot = 0; slot < TARGETS; slot++)
+                textures[unit][slot] = UNKNOWN;
+        }
+    }
+    // per frame counters, reset by the caller
+    // ------------------------------------------------------------------------
+    Stats& frameStats()
+    {
+        return stat;
+    }
+
+private:
+    static const unsigned int UNKNOWN = 0xFFFFFFFF;
+    static const int TARGETS = 4;
+
+    unsigned int program;
+    unsigned int pipeline;
+    unsigned int vertexArray;
+    unsigned int activeUnit;
+    unsigned int textures[MAX_UNITS][TARGETS];
+    Stats stat;
+
+    // ------------------------------------------------------------------------
+    bool changed(unsigned int& current, unsigned int id)
+    {
+        if (current == id)
+        {
+            stat.elided++;
+            return false;
+        }
+        current = id;
+        stat.issued++;
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    static int targetSlot(GLenum target)
+    {
+        switch (target)
+        {
+            case GL_TEXTURE_2D:       return 0;
+            case GL_TEXTURE_CUBE_MAP: return 1;
+            case GL_TEXTURE_3D:       return 2;
+            case GL_TEXTURE_2D_ARRAY: return 3;
+        }
+        return -1;
+    }
+#ifdef DEBUG
+    // ------------------------------------------------------------------------
+    static GLenum bindingQuery(GLenum target)
+    {
+        switch (target)
+        {
+            case GL_TEXTURE_CUBE_MAP: return GL_TEXTURE_BINDING_CUBE_MAP;
+            case GL_TEXTURE_3D:       return GL_TEXTURE_BINDING_3D;
+            case GL_TEXTURE_2D_ARRAY: return GL_TEXTURE_BINDING_2D_ARRAY;
+        }
+        return GL_TEXTURE_BINDING_2D;
+    }
+    // ------------------------------------------------------------------------
+    static void verify(GLenum query, unsigned int cached, const char* what)
+    {
+        if (cached == UNKNOWN)
+            return;
+        int real = 0;
+        glGetIntegerv(query, &real);
+        if ((unsigned int)real != cached)
+            std::cout << "ERROR::GLSTATE::OUT_OF_SYNC " << what << " cached=" << cached << " real=" << real << std::endl;
+    }
+#endif
+};
+
+inline GLState& glstate()
+{
+    static GLState state;
+    return state;
+}
+
+#endif /* GLState_h */
@@ -0,0 +1,384 @@
+//
+//  GeometryArena.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef GeometryArena_h
+#define GeometryArena_h
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+#include "GLState.h"
+#include "VertexLayout.h"
+#include "BufferAllocator.h"
+#include "RenderQueue.h"
+
+// where one mesh lives inside a GeometryArena
+struct MeshRange
+{
+    unsigned int first = 0;   // first index, or first vertex when not indexed
+    unsigned int count = 0;   // indices, or vertices when not indexed
+    int baseVertex = 0;       // added to every index by the draw
+    GLenum indexType = 0;     // 0 for array draws
+};
+
+// every mesh with the same vertex layout in one VBO + EBO behind one VAO,
+// carved up by BufferAllocator. indices stay local to their mesh and the draw
+// adds baseVertex, so switching meshes never rebinds anything:
+//
+//   GeometryArena arena(POSITION_COLOR);
+//   unsigned int quad = arena.add(vertices, 4, indices, 6);
+//   glstate().bindVertexArray(arena.VAO());
+//   arena.draw(quad);
+//
+// the buffers grow by doubling when full. remove() leaves holes, defragment()
+// packs the live meshes into right-sized buffers on the GPU and changes their
+// ranges, so look ranges up again afterwards instead of caching them.
+class GeometryArena
+{
+public:
+    struct Stats
+    {
+        unsigned int meshes = 0;
+        size_t vertexBytes = 0;    // reserved by live meshes
+        size_t indexBytes = 0;
+        size_t capacityBytes = 0;  // VBO + EBO size
+        unsigned int grows = 0;
+        unsigned int defragments = 0;
+    };
+
+    static const unsigned int INVALID = 0xFFFFFFFF;
+
+    // indexType is GL_UNSIGNED_SHORT or GL_UNSIGNED_INT for every indexed mesh
+    // in the arena. 16 bits only limit the vertices of one mesh, not the arena.
+    GeometryArena(const VertexLayout& layout, GLenum indexType = GL_UNSIGNED_SHORT,
+                  unsigned int vertexCapacity = 1 << 14, unsigned int indexCapacity = 1 << 15)
+        : layout(layout), indexType(indexType), vertexCapacity(vertexCapacity), indexCapacity(indexCapacity),
+          vertexArray(0), VBO(0), EBO(0)
+    {
+        create();
+    }
+    // vertices in the arena's layout, indices (may be NULL) in its index type.
+    // returns the mesh handle, INVALID on failure
+    // ------------------------------------------------------------------------
+    unsigned int add(const void* vertices, unsigned int vertexCount, const void* indices = NULL, unsigned int indexCount = 0)
+    {
+        if (indices && indexType == GL_UNSIGNED_SHORT && vertexCount > 0xFFFF + 1)
+        {
+            std::cout << "ERROR::GEOMETRY_ARENA::TOO_MANY_VERTICES_FOR_16BIT_INDICES " << vertexCount << std::endl;
+            return INVALID;
+        }
+
+        Mesh mesh;
+        mesh.vertexOffset = reserve(vertexAllocator, VBO, layout.stride(), vertexCount);
+        if (mesh.vertexOffset == BufferAllocator::INVALID)
+            return INVALID;
+        if (indices)
+        {
+            mesh.indexOffset = reserve(indexAllocator, EBO, indexSize(), indexCount);
+            if (mesh.indexOffset == BufferAllocator::INVALID)
+            {
+                vertexAllocator.free(mesh.vertexOffset);
+                return INVALID;
+            }
+        }
+        mesh.vertexCount = vertexCount;
+        mesh.indexCount = indices ? indexCount : 0;
+        mesh.live = true;
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (size_t)mesh.vertexOffset * layout.stride(), (size_t)vertexCount * layout.stride(), vertices);
+        if (indices)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+            glBufferSubData(GL_COPY_WRITE_BUFFER, (size_t)mesh.indexOffset * indexSize(), (size_t)indexCount * indexSize(), indices);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        // reuse the slot of a removed mesh
+        unsigned int handle = (unsigned int)meshes.size();
+        if (!freeHandles.empty())
+        {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+            meshes[handle] = mesh;
+        }
+        else
+        {
+            meshes.push_back(mesh);
+        }
+        stat.meshes++;
+        return handle;
+    }
+    // the space goes back to the allocators, the buffers keep their size
+    // ------------------------------------------------------------------------
+    void remove(unsigned int handle)
+    {
+        if (handle >= meshes.size() || !meshes[handle].live)
+            return;
+        Mesh& mesh = meshes[handle];
+        vertexAllocator.free(mesh.vertexOffset);
+        if (mesh.indexOffset != BufferAllocator::INVALID)
+            indexAllocator.free(mesh.indexOffset);
+        mesh = Mesh();
+        freeHandles.push_back(handle);
+        stat.meshes--;
+    }
+    // ------------------------------------------------------------------------
+    MeshRange range(unsigned int handle) const
+    {
+        MeshRange result;
+        if (handle >= meshes.size() || !meshes[handle].live)
+            return result;
+        const Mesh& mesh = meshes[handle];
+        if (mesh.indexCount)
+        {
+            result.first = mesh.indexOffset;
+            result.count = mesh.indexCount;
+            result.baseVertex = (int)mesh.vertexOffset;
+            result.indexType = indexType;
+        }
+        else
+        {
+            result.first = mesh.vertexOffset;
+            result.count = mesh.vertexCount;
+        }
+        return result;
+    }
+    // a RenderQueue item for the mesh, program and textures are left to the caller
+    // ------------------------------------------------------------------------
+    DrawItem drawItem(unsigned int handle) const
+    {
+        MeshRange mesh = range(handle);
+        DrawItem item;
+        item.VAO = vertexArray;
+        item.indexType = mesh.indexType;
+        item.first = mesh.first;
+        item.count = mesh.count;
+        item.baseVertex = mesh.baseVertex;
+        return item;
+    }
+    // with VAO() bound
+    // ------------------------------------------------------------------------
+    void draw(unsigned int handle, GLenum mode = GL_TRIANGLES) const
+    {
+        MeshRange mesh = range(handle);
+        if (mesh.indexType)
+            glDrawElementsBaseVertex(mode, mesh.count, mesh.indexType, (void*)((size_t)mesh.first * indexSize()), mesh.baseVertex);
+        else
+            glDrawArrays(mode, mesh.first, mesh.count);
+    }
+    // copy the live meshes into buffers just big enough for them, largest
+    // first so the buddy blocks pack without holes. handles stay valid,
+    // ranges change. returns the bytes given back to the driver.
+    // ------------------------------------------------------------------------
+    size_t defragment()
+    {
+        size_t before = capacityBytes();
+
+        std::vector<unsigned int> order;
+        for (unsigned int i = 0; i < meshes.size(); i++)
+        {
+            if (meshes[i].live)
+                order.push_back(i);
+        }
+        const BufferAllocator& vertexSizes = vertexAllocator;
+        std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b)
+        {
+            return vertexSizes.size(meshes[a].vertexOffset) > vertexSizes.size(meshes[b].vertexOffset);
+        });
+        vertexAllocator = compact(vertexAllocator, VBO, layout.stride(), order, &Mesh::vertexOffset);
+
+        std::vector<unsigned int> indexed;
+        for (unsigned int i : order)
+        {
+            if (meshes[i].indexOffset != BufferAllocator::INVALID)
+                indexed.push_back(i);
+        }
+        const BufferAllocator& indexSizes = indexAllocator;
+        std::sort(indexed.begin(), indexed.end(), [&](unsigned int a, unsigned int b)
+        {
+            return indexSizes.size(meshes[a].indexOffset) > indexSizes.size(meshes[b].indexOffset);
+        });
+        indexAllocator = compact(indexAllocator, EBO, indexSize(), indexed, &Mesh::indexOffset);
+
+        attach();
+        stat.defragments++;
+        return before - capacityBytes();
+    }
+    // every handle becomes invalid. the GL objects are replaced by new ones
+    // at the constructor's capacities, so VAO() changes and the arena can be
+    // filled again
+    // ------------------------------------------------------------------------
+    void clear()
+    {
+        glDeleteVertexArrays(1, &vertexArray);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        meshes.clear();
+        freeHandles.clear();
+        // a deleted VAO that was bound reverts the binding to 0
+        glstate().invalidate();
+        stat = Stats();
+        create();
+    }
+    // ------------------------------------------------------------------------
+    unsigned int VAO() const
+    {
+        return vertexArray;
+    }
+    const Stats& stats()
+    {
+        stat.vertexBytes = (size_t)vertexAllocator.used() * layout.stride();
+        stat.indexBytes = (size_t)indexAllocator.used() * indexSize();
+        stat.capacityBytes = capacityBytes();
+        return stat;
+    }
+
+private:
+    struct Mesh
+    {
+        unsigned int vertexOffset = BufferAllocator::INVALID;  // in vertices
+        unsigned int vertexCount = 0;
+        unsigned int indexOffset = BufferAllocator::INVALID;   // in indices
+        unsigned int indexCount = 0;
+        bool live = false;
+    };
+
+    VertexLayout layout;
+    GLenum indexType;
+    unsigned int vertexCapacity;   // what create() starts from
+    unsigned int indexCapacity;
+    BufferAllocator vertexAllocator;
+    BufferAllocator indexAllocator;
+    unsigned int vertexArray;
+    unsigned int VBO;
+    unsigned int EBO;
+    std::vector<Mesh> meshes;
+    std::vector<unsigned int> freeHandles;
+    Stats stat;
+
+    // ------------------------------------------------------------------------
+    unsigned int indexSize() const
+    {
+        return indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+    }
+    size_t capacityBytes() const
+    {
+        return (size_t)vertexAllocator.capacity() * layout.stride() + (size_t)indexAllocator.capacity() * indexSize();
+    }
+    // fresh allocators, buffers and VAO at the initial capacities
+    // ------------------------------------------------------------------------
+    void create()
+    {
+        vertexAllocator = BufferAllocator(vertexCapacity);
+        indexAllocator = BufferAllocator(indexCapacity);
+        glGenVertexArrays(1, &vertexArray);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, (size_t)vertexAllocator.capacity() * layout.stride(), NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, (size_t)indexAllocator.capacity() * indexSize(), NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        attach();
+    }
+    // point the VAO at the current buffers. the element buffer binding is
+    // part of VAO state, so it is bound while the VAO is
+    // ------------------------------------------------------------------------
+    void attach()
+    {
+        glstate().bindVertexArray(vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        layout.apply();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        // unbind VBO
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // unbind VAO
+        glstate().bindVertexArray(0);
+    }
+    // allocate count units, doubling the allocator and its buffer until they fit.
+    // a failed grow still leaves the buffer matching the allocator
+    // ------------------------------------------------------------------------
+    unsigned int reserve(BufferAllocator& allocator, unsigned int& buffer, unsigned int unitSize, unsigned int count)
+    {
+        unsigned int offset = allocator.allocate(count);
+        if (offset != BufferAllocator::INVALID)
+            return offset;
+
+        unsigned int oldCapacity = allocator.capacity();
+        while (offset == BufferAllocator::INVALID && allocator.capacity() < 0x80000000u)
+        {
+            allocator.grow(oldCapacity ? allocator.capacity() * 2 : count);
+            offset = allocator.allocate(count);
+        }
+        if (allocator.capacity() != oldCapacity)
+            resize(allocator, buffer, unitSize, oldCapacity);
+        if (offset == BufferAllocator::INVALID)
+        {
+            std::cout << "ERROR::GEOMETRY_ARENA::OUT_OF_SPACE " << count << std::endl;
+            return BufferAllocator::INVALID;
+        }
+        return offset;
+    }
+    // buffer grown to the allocator's capacity, its first oldCapacity units kept
+    // ------------------------------------------------------------------------
+    void resize(const BufferAllocator& allocator, unsigned int& buffer, unsigned int unitSize, unsigned int oldCapacity)
+    {
+        // live data keeps its offsets, only the buffer object changes
+        unsigned int grown = 0;
+        glGenBuffers(1, &grown);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+        glBufferData(GL_COPY_WRITE_BUFFER, (size_t)allocator.capacity() * unitSize, NULL, GL_STATIC_DRAW);
+        if (oldCapacity)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (size_t)oldCapacity * unitSize);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+        buffer = grown;
+        attach();
+        stat.grows++;
+    }
+    // move the blocks of meshes, in that order, into a fresh allocator and a
+    // buffer sized to what they use. offset points at the Mesh field to update
+    // ------------------------------------------------------------------------
+    BufferAllocator compact(const BufferAllocator& allocator, unsigned int& buffer, unsigned int unitSize,
+                            const std::vector<unsigned int>& order, unsigned int Mesh::* offset)
+    {
+        BufferAllocator packed(allocator.used() ? allocator.used() : 1);
+
+        unsigned int target = 0;
+        glGenBuffers(1, &target);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, target);
+        glBufferData(GL_COPY_WRITE_BUFFER, (size_t)packed.capacity() * unitSize, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        for (unsigned int i : order)
+        {
+            Mesh& mesh = meshes[i];
+            unsigned int size = allocator.size(mesh.*offset);
+            unsigned int moved = packed.allocate(size);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (size_t)(mesh.*offset) * unitSize,
+                                (size_t)moved * unitSize, (size_t)size * unitSize);
+            mesh.*offset = moved;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+        buffer = target;
+        return packed;
+    }
+};
+
+#endif /* GeometryArena_h */
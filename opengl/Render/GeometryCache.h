@@ -0,0 +1,103 @@
+//
+//  GeometryCache.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef GeometryCache_h
+#define GeometryCache_h
+
+#include <glad/glad.h>
+
+#include <unordered_map>
+#include <iostream>
+
+#include "Hash.h"
+#include "GLState.h"
+#include "VertexLayout.h"
+
+// creates a VBO + VAO the first time a vertex array with this content and
+// layout is seen and hands the same VAO back on every later call, so code that
+// declares its geometry inline each frame stops leaking GL objects. the key is
+// a hash of the bytes, which is cheap for small inline arrays; keep the
+// returned VAO instead of calling this per frame for big meshes.
+class GeometryCache
+{
+public:
+    struct Stats
+    {
+        unsigned int vertexArrays = 0;  // live VAOs
+        unsigned int buffers = 0;       // live VBOs
+        unsigned int hits = 0;
+        unsigned int misses = 0;
+    };
+
+    // ------------------------------------------------------------------------
+    unsigned int vertexArray(const void* vertices, size_t size, const VertexLayout& layout)
+    {
+        unsigned long long key = fnv1a((const char*)vertices, size);
+        key = fnv1a((const char*)&layout, sizeof(layout), key);
+
+        auto found = entries.find(key);
+        if (found != entries.end())
+        {
+            stat.hits++;
+            return found->second.VAO;
+        }
+        stat.misses++;
+
+        Entry entry;
+        glGenBuffers(1, &entry.VBO);
+        glGenVertexArrays(1, &entry.VAO);
+
+        glstate().bindVertexArray(entry.VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, entry.VBO);
+        glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+
+        // read vertex
+        layout.apply();
+
+        // unbind VBO
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // unbind VAO
+        glstate().bindVertexArray(0);
+
+        entries[key] = entry;
+        stat.vertexArrays++;
+        stat.buffers++;
+        return entry.VAO;
+    }
+    // ------------------------------------------------------------------------
+    void clear()
+    {
+        for (auto& item : entries)
+        {
+            glDeleteVertexArrays(1, &item.second.VAO);
+            glDeleteBuffers(1, &item.second.VBO);
+        }
+        entries.clear();
+        // a deleted VAO that was bound reverts the binding to 0
+        glstate().invalidate();
+        stat.vertexArrays = 0;
+        stat.buffers = 0;
+    }
+    // ------------------------------------------------------------------------
+    const Stats& stats() const
+    {
+        return stat;
+    }
+
+private:
+    struct Entry
+    {
+        unsigned int VAO;
+        unsigned int VBO;
+    };
+    std::unordered_map<unsigned long long, Entry> entries;
+    Stats stat;
+};
+
+#endif /* GeometryCache_h */
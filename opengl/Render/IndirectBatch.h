@@ -0,0 +1,257 @@
+//
+//  IndirectBatch.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef IndirectBatch_h
+#define IndirectBatch_h
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <cstring>
+
+#include "GLExtensions.h"
+#include "InstanceBuffer.h"
+#include "GLState.h"
+
+// layouts fixed by the GL spec for indirect draws
+struct DrawArraysIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+
+struct DrawElementsIndirectCommand
+{
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// collects triangle draws from many meshes that share buffers and issues one
+// glMultiDraw*Indirect per program/VAO bucket. every draw carries a model
+// matrix, written to an InstanceBuffer and selected by the command's
+// baseInstance, so a shader written for instancing (mat4 at location) reads
+// its per-draw data unchanged.
+//
+// without GL 4.3 the same commands are replayed one call each, with base
+// instance draws on 4.2 or by moving the instance attribute before each draw
+// on 3.3 and macOS.
+//
+//   batch.drawElements(shader.ID, VAO, GL_UNSIGNED_INT, firstIndex, count, baseVertex, model);
+//   ...
+//   batch.flush();
+class IndirectBatch
+{
+public:
+    struct Stats
+    {
+        unsigned int draws = 0;    // commands recorded
+        unsigned int buckets = 0;  // program/VAO combinations flushed
+        unsigned int calls = 0;    // draw calls that reached the driver
+
+        void reset()
+        {
+            draws = buckets = calls = 0;
+        }
+    };
+
+    // the per-draw matrix is read at location .. location + 3, perDraw has to
+    // be attached to every VAO drawn through this batch
+    IndirectBatch(InstanceBuffer& perDraw, unsigned int location)
+        : perDraw(perDraw), location(location), commandBuffer(0), capacity(0), used(0)
+    {
+        if (glext().multiDrawIndirect)
+            glGenBuffers(1, &commandBuffer);
+    }
+    // vertices first .. first + count of VAO
+    // ------------------------------------------------------------------------
+    void drawArrays(unsigned int program, unsigned int VAO, unsigned int first, unsigned int count, const float* model)
+    {
+        DrawArraysIndirectCommand command = { count, 1, first, addModel(model) };
+        bucket(program, VAO, 0).arrays.push_back(command);
+    }
+    // count indices of type indexType starting at firstIndex, offset by baseVertex
+    // ------------------------------------------------------------------------
+    void drawElements(unsigned int program, unsigned int VAO, GLenum indexType, unsigned int firstIndex, unsigned int count, int baseVertex, const float* model)
+    {
+        DrawElementsIndirectCommand command = { count, 1, firstIndex, baseVertex, addModel(model) };
+        bucket(program, VAO, indexType).elements.push_back(command);
+    }
+    // upload the matrices, issue every bucket and start recording again.
+    // leaves the last bucket's program and VAO bound.
+    // ------------------------------------------------------------------------
+    void flush()
+    {
+        if (!models.empty())
+            perDraw.update(models.data(), models.size() / 16);
+
+        if (glext().multiDrawIndirect)
+            submitIndirect();
+        else
+            submitLoop();
+
+        // keep the vectors' storage, steady frames do not allocate
+        for (size_t i = 0; i < used; i++)
+        {
+            buckets[i].arrays.clear();
+            buckets[i].elements.clear();
+        }
+        models.clear();
+        used = 0;
+    }
+    // ------------------------------------------------------------------------
+    Stats& stats()
+    {
+        return stat;
+    }
+
+private:
+    struct Bucket
+    {
+        unsigned int program;
+        unsigned int VAO;
+        GLenum indexType;  // 0 for array draws
+        std::vector<DrawArraysIndirectCommand> arrays;
+        std::vector<DrawElementsIndirectCommand> elements;
+    };
+
+    InstanceBuffer& perDraw;
+    unsigned int location;
+    unsigned int commandBuffer;
+    size_t capacity;
+    std::vector<Bucket> buckets;
+    size_t used;  // buckets in use this frame, the rest are kept for reuse
+    std::vector<float> models;
+    Stats stat;
+
+    // ------------------------------------------------------------------------
+    GLuint addModel(const float* model)
+    {
+        GLuint index = (GLuint)(models.size() / 16);
+        models.insert(models.end(), model, model + 16);
+        stat.draws++;
+        return index;
+    }
+    // a frame has a handful of buckets, a linear search beats hashing
+    // ------------------------------------------------------------------------
+    Bucket& bucket(unsigned int program, unsigned int VAO, GLenum indexType)
+    {
+        for (size_t i = 0; i < used; i++)
+        {
+            if (buckets[i].program == program && buckets[i].VAO == VAO && buckets[i].indexType == indexType)
+                return buckets[i];
+        }
+        if (used == buckets.size())
+            buckets.push_back(Bucket());
+        Bucket& b = buckets[used++];
+        b.program = program;
+        b.VAO = VAO;
+        b.indexType = indexType;
+        return b;
+    }
+    // ------------------------------------------------------------------------
+    void submitIndirect()
+    {
+        size_t size = 0;
+        for (size_t i = 0; i < used; i++)
+            size += commandBytes(buckets[i]);
+        if (size == 0)
+            return;
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        if (size > capacity)
+            capacity = size;
+        // orphan, last frame's commands may still be in flight
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity, NULL, GL_STREAM_DRAW);
+
+        size_t offset = 0;
+        for (size_t i = 0; i < used; i++)
+        {
+            const Bucket& b = buckets[i];
+            size_t bytes = commandBytes(b);
+            if (bytes == 0)
+                continue;
+            if (b.indexType)
+                glBufferSubData(GL_DRAW_INDIRECT_BUFFER, offset, bytes, b.elements.data());
+            else
+                glBufferSubData(GL_DRAW_INDIRECT_BUFFER, offset, bytes, b.arrays.data());
+
+            glstate().useProgram(b.program);
+            glstate().bindVertexArray(b.VAO);
+            if (b.indexType)
+                glext().MultiDrawElementsIndirect(GL_TRIANGLES, b.indexType, (void*)offset, (GLsizei)b.elements.size(), 0);
+            else
+                glext().MultiDrawArraysIndirect(GL_TRIANGLES, (void*)offset, (GLsizei)b.arrays.size(), 0);
+            offset += bytes;
+            stat.buckets++;
+            stat.calls++;
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    // ------------------------------------------------------------------------
+    void submitLoop()
+    {
+        bool baseInstance = glext().baseInstance;
+        for (size_t i = 0; i < used; i++)
+        {
+            const Bucket& b = buckets[i];
+            if (b.arrays.empty() && b.elements.empty())
+                continue;
+            glstate().useProgram(b.program);
+            glstate().bindVertexArray(b.VAO);
+
+            for (const DrawArraysIndirectCommand& c : b.arrays)
+            {
+                if (baseInstance)
+                {
+                    glext().DrawArraysInstancedBaseInstance(GL_TRIANGLES, c.first, c.count, c.instanceCount, c.baseInstance);
+                }
+                else
+                {
+                    perDraw.offset(location, c.baseInstance);
+                    glDrawArraysInstanced(GL_TRIANGLES, c.first, c.count, c.instanceCount);
+                }
+            }
+            size_t indexSize = indexBytes(b.indexType);
+            for (const DrawElementsIndirectCommand& c : b.elements)
+            {
+                void* indices = (void*)(c.firstIndex * indexSize);
+                if (baseInstance)
+                {
+                    glext().DrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, c.count, b.indexType, indices, c.instanceCount, c.baseVertex, c.baseInstance);
+                }
+                else
+                {
+                    perDraw.offset(location, c.baseInstance);
+                    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, c.count, b.indexType, indices, c.instanceCount, c.baseVertex);
+                }
+            }
+            // put the attribute back for ordinary instanced draws
+            if (!baseInstance)
+                perDraw.offset(location, 0);
+
+            stat.buckets++;
+            stat.calls += (unsigned int)(b.arrays.size() + b.elements.size());
+        }
+    }
+    // ------------------------------------------------------------------------
+    static size_t commandBytes(const Bucket& b)
+    {
+        return b.indexType ? b.elements.size() * sizeof(DrawElementsIndirectCommand)
+                           : b.arrays.size() * sizeof(DrawArraysIndirectCommand);
+    }
+    static size_t indexBytes(GLenum type)
+    {
+        return type == GL_UNSIGNED_BYTE ? 1 : type == GL_UNSIGNED_SHORT ? 2 : 4;
+    }
+};
+
+#endif /* IndirectBatch_h */
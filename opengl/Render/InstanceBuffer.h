@@ -0,0 +1,88 @@
+//
+//  InstanceBuffer.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef InstanceBuffer_h
+#define InstanceBuffer_h
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+#include "GLState.h"
+
+// per-instance model matrices in an instance-rate vertex buffer. a mat4
+// attribute takes four consecutive locations, one column each, and every
+// column advances once per instance instead of once per vertex.
+//
+//   instances.attach(VAO, 3);                 // layout (location = 3) in mat4
+//   instances.update(matrices, count);
+//   glDrawArraysInstanced(GL_TRIANGLES, 0, 36, count);
+class InstanceBuffer
+{
+public:
+    unsigned int ID;
+
+    InstanceBuffer()
+        : ID(0), capacity(0), instances(0)
+    {
+        glGenBuffers(1, &ID);
+    }
+    // point the four columns at location .. location + 3 of VAO
+    // ------------------------------------------------------------------------
+    void attach(unsigned int VAO, unsigned int location)
+    {
+        glstate().bindVertexArray(VAO);
+        offset(location, 0);
+        glstate().bindVertexArray(0);
+    }
+    // make instance 0 of the bound VAO read matrix first. stands in for
+    // base instance on drivers that do not have it
+    // ------------------------------------------------------------------------
+    void offset(unsigned int location, size_t first)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, ID);
+        for (unsigned int column = 0; column < 4; column++)
+        {
+            glVertexAttribPointer(location + column, 4, GL_FLOAT, GL_FALSE, 16 * sizeof(float), (void*)((first * 16 + column * 4) * sizeof(float)));
+            glEnableVertexAttribArray(location + column);
+            glVertexAttribDivisor(location + column, 1);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    // count column-major matrices, 16 floats each
+    // ------------------------------------------------------------------------
+    void update(const float* matrices, size_t count)
+    {
+        size_t size = count * 16 * sizeof(float);
+        glBindBuffer(GL_ARRAY_BUFFER, ID);
+        if (size > capacity)
+        {
+            glBufferData(GL_ARRAY_BUFFER, size, matrices, GL_STREAM_DRAW);
+            capacity = size;
+        }
+        else
+        {
+            // orphan the old storage so the driver does not wait for the
+            // previous frame's draw to finish reading it
+            glBufferData(GL_ARRAY_BUFFER, capacity, NULL, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, size, matrices);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        instances = count;
+    }
+    // ------------------------------------------------------------------------
+    size_t count() const
+    {
+        return instances;
+    }
+
+private:
+    size_t capacity;
+    size_t instances;
+};
+
+#endif /* InstanceBuffer_h */
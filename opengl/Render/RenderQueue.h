@@ -0,0 +1,264 @@
+//
+//  RenderQueue.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef RenderQueue_h
+#define RenderQueue_h
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <initializer_list>
+
+#include "GLState.h"
+
+// one draw as submitted to the RenderQueue
+struct DrawItem
+{
+    unsigned int program = 0;
+    unsigned int VAO = 0;
+    unsigned int textureSet = 0;  // from RenderQueue::textureSet(), 0 binds nothing
+    GLenum mode = GL_TRIANGLES;
+    GLenum indexType = 0;         // 0 draws arrays
+    unsigned int first = 0;       // first vertex, or first index for element draws
+    unsigned int count = 0;
+    int baseVertex = 0;           // added to each index, for meshes sharing one buffer
+    // per-draw uniforms, called once the item's state is bound
+    void (*prepare)(const void* data) = NULL;
+    const void* data = NULL;
+};
+
+// draws are pushed in any order and flushed once per frame. each item gets a
+// 64-bit key, most expensive state in the highest bits:
+//
+//   63      48 47      36 35      24 23             0
+//   | program | textures |   VAO    |     depth      |
+//
+// the queue radix sorts the keys and only calls glUseProgram, glBindVertexArray
+// and the texture binds when that part of the state actually changes. within
+// equal state items go front to back.
+class RenderQueue
+{
+public:
+    struct Stats
+    {
+        unsigned int items = 0;
+        unsigned int programs = 0;        // state changes issued after sorting
+        unsigned int vertexArrays = 0;
+        unsigned int textureSets = 0;
+        unsigned int unsortedPrograms = 0;  // what submission order would have cost
+        unsigned int unsortedVertexArrays = 0;
+        unsigned int unsortedTextureSets = 0;
+
+        unsigned int sorted() const
+        {
+            return programs + vertexArrays + textureSets;
+        }
+        unsigned int unsorted() const
+        {
+            return unsortedPrograms + unsortedVertexArrays + unsortedTextureSets;
+        }
+        // negative when sorting cost more changes than submission order
+        long long saved() const
+        {
+            return (long long)unsorted() - (long long)sorted();
+        }
+        void reset()
+        {
+            *this = Stats();
+        }
+    };
+
+    // useProgram binds item.program, GLState::useProgram when NULL. lets the program
+    // be a pipeline object or anything else that fits in an unsigned int.
+    RenderQueue(void (*useProgram)(unsigned int) = NULL)
+        : useProgram(useProgram)
+    {
+    }
+    // textures bound to units 0, 1, ... as GL_TEXTURE_2D. the same list always
+    // returns the same id
+    // ------------------------------------------------------------------------
+    unsigned int textureSet(std::initializer_list<unsigned int> textures)
+    {
+        TextureSet set;
+        for (unsigned int texture : textures)
+        {
+            if (set.count < MAX_TEXTURES)
+                set.textures[set.count++] = texture;
+        }
+        for (size_t i = 0; i < textureSets.size(); i++)
+        {
+            if (textureSets[i].equals(set))
+                return (unsigned int)i + 1;
+        }
+        textureSets.push_back(set);
+        return (unsigned int)textureSets.size();
+    }
+    // depth is the view distance mapped to 0..1, nearer draws first. the
+    // unsorted counts follow the same rules as flush()
+    // ------------------------------------------------------------------------
+    void push(const DrawItem& item, float depth = 0.0f)
+    {
+        if (!items.empty())
+        {
+            const DrawItem& last = items.back();
+            stat.unsortedPrograms += last.program != item.program;
+            stat.unsortedVertexArrays += last.VAO != item.VAO;
+        }
+        else
+        {
+            stat.unsortedPrograms++;
+            stat.unsortedVertexArrays++;
+            submittedTextures = 0;
+        }
+        // set 0 binds nothing, the previous set stays bound
+        if (item.textureSet != submittedTextures && item.textureSet != 0)
+        {
+            stat.unsortedTextureSets++;
+            submittedTextures = item.textureSet;
+        }
+
+        depth = depth < 0.0f ? 0.0f : depth > 1.0f ? 1.0f : depth;
+        SortEntry entry;
+        entry.key = (unsigned long long)(item.program & 0xFFFF) << 48
+            | (unsigned long long)(item.textureSet & 0xFFF) << 36
+            | (unsigned long long)(item.VAO & 0xFFF) << 24
+            | (unsigned long long)(depth * 0xFFFFFF);
+        entry.index = (unsigned int)items.size();
+        keys.push_back(entry);
+        items.push_back(item);
+    }
+    // sort, draw and empty the queue. bindings are left as the last item set them
+    // ------------------------------------------------------------------------
+    void flush()
+    {
+        sort();
+
+        // the key only holds the low bits of each name, compare the real values
+        bool first = true;
+        unsigned int program = 0, VAO = 0, textures = 0;
+        for (const SortEntry& entry : keys)
+        {
+            const DrawItem& item = items[entry.index];
+            if (first || item.program != program)
+            {
+                if (useProgram)
+                    useProgram(item.program);
+                else
+                    glstate().useProgram(item.program);
+                program = item.program;
+                stat.programs++;
+            }
+            if (first || item.VAO != VAO)
+            {
+                glstate().bindVertexArray(item.VAO);
+                VAO = item.VAO;
+                stat.vertexArrays++;
+            }
+            if (item.textureSet != textures && item.textureSet != 0)
+            {
+                const TextureSet& set = textureSets[item.textureSet - 1];
+                for (unsigned int unit = 0; unit < set.count; unit++)
+                    glstate().bindTexture(unit, GL_TEXTURE_2D, set.textures[unit]);
+                textures = item.textureSet;
+                stat.textureSets++;
+            }
+            first = false;
+
+            if (item.prepare)
+                item.prepare(item.data);
+            if (item.indexType && item.baseVertex)
+                glDrawElementsBaseVertex(item.mode, item.count, item.indexType, (void*)(item.first * indexBytes(item.indexType)), item.baseVertex);
+            else if (item.indexType)
+                glDrawElements(item.mode, item.count, item.indexType, (void*)(item.first * indexBytes(item.indexType)));
+            else
+                glDrawArrays(item.mode, item.first, item.count);
+        }
+        stat.items += (unsigned int)items.size();
+
+        // keep the storage, steady frames do not allocate
+        items.clear();
+        keys.clear();
+    }
+    // ------------------------------------------------------------------------
+    Stats& stats()
+    {
+        return stat;
+    }
+
+private:
+    static const unsigned int MAX_TEXTURES = 4;
+
+    struct TextureSet
+    {
+        unsigned int textures[MAX_TEXTURES] = {};
+        unsigned int count = 0;
+
+        bool equals(const TextureSet& other) const
+        {
+            if (count != other.count)
+                return false;
+            for (unsigned int i = 0; i < count; i++)
+            {
+                if (textures[i] != other.textures[i])
+                    return false;
+            }
+            return true;
+        }
+    };
+    struct SortEntry
+    {
+        unsigned long long key;
+        unsigned int index;
+    };
+
+    void (*useProgram)(unsigned int);
+    std::vector<DrawItem> items;
+    std::vector<SortEntry> keys;
+    std::vector<SortEntry> scratch;
+    std::vector<TextureSet> textureSets;
+    unsigned int submittedTextures = 0;  // bound set in submission order
+    Stats stat;
+
+    // lsd radix sort, 8 bits per pass. stable, so equal keys keep submission
+    // order. passes where every key has the same byte are skipped, which is
+    // most of them when a frame only uses a few programs and VAOs.
+    // ------------------------------------------------------------------------
+    void sort()
+    {
+        size_t n = keys.size();
+        if (n < 2)
+            return;
+        scratch.resize(n);
+
+        for (unsigned int shift = 0; shift < 64; shift += 8)
+        {
+            size_t counts[256] = {};
+            for (const SortEntry& entry : keys)
+                counts[(entry.key >> shift) & 0xFF]++;
+            if (counts[(keys[0].key >> shift) & 0xFF] == n)
+                continue;
+
+            size_t offset = 0;
+            for (size_t& count : counts)
+            {
+                size_t c = count;
+                count = offset;
+                offset += c;
+            }
+            for (const SortEntry& entry : keys)
+                scratch[counts[(entry.key >> shift) & 0xFF]++] = entry;
+            keys.swap(scratch);
+        }
+    }
+    // ------------------------------------------------------------------------
+    static size_t indexBytes(GLenum type)
+    {
+        return type == GL_UNSIGNED_BYTE ? 1 : type == GL_UNSIGNED_SHORT ? 2 : 4;
+    }
+};
+
+#endif /* RenderQueue_h */
@@ -0,0 +1,234 @@
+//
+//  StreamBuffer.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef StreamBuffer_h
+#define StreamBuffer_h
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+#include "GLExtensions.h"
+
+// vertex data that is rebuilt every frame (debug lines, UI, particles) written
+// by the CPU straight into buffer memory the GPU reads from.
+//
+// with GL 4.4 / ARB_buffer_storage the buffer is FRAMES regions of frameSize,
+// mapped once, persistently and coherently. each frame writes the next region
+// and fences it after its draws; begin() only waits when the GPU is still
+// reading the region from FRAMES frames ago. older contexts (macOS stops at
+// 4.1) orphan the buffer every frame and map it unsynchronized instead, the
+// driver hands out fresh storage while the old one is still in flight.
+//
+// a frame may hold any number of allocate / commit / draw rounds, so debug
+// lines, UI and particles can each write and draw in turn. after a commit
+// the fallback maps the part of the frame nobody has written yet again,
+// unsynchronized, since no draw issued so far reads it.
+//
+//   stream.begin();
+//   StreamBuffer::Allocation lines = stream.allocate(count * stride, stride);
+//   ... write count vertices to lines.data
+//   stream.commit();
+//   glDrawArrays(GL_LINES, (GLint)(lines.offset / stride), count);  // VAO reads stream.ID
+//   ... more allocate / commit / draw
+//   stream.end();
+class StreamBuffer
+{
+public:
+    static const unsigned int FRAMES = 3;
+
+    struct Allocation
+    {
+        void* data = NULL;  // NULL when the frame's region is full
+        size_t offset = 0;  // bytes from the start of ID
+    };
+    struct Stats
+    {
+        unsigned int frames = 0;
+        size_t bytes = 0;
+        unsigned int stalls = 0;     // begin() had to wait for the GPU
+        unsigned int overflows = 0;  // allocations that did not fit
+    };
+
+    unsigned int ID;
+
+    // frameSize is the most one frame may write. needs glext().load() first
+    StreamBuffer(size_t frameSize)
+        : ID(0), frameSize(frameSize), region(0), head(0), base(NULL), mapped(NULL), mappedFrom(0), fences{},
+          persistentMapping(glext().bufferStorage), recording(false)
+    {
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        if (persistentMapping)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glext().BufferStorage(GL_COPY_WRITE_BUFFER, frameSize * FRAMES, NULL, flags);
+            base = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, frameSize * FRAMES, flags);
+            if (!base)
+            {
+                // immutable storage cannot be respecified, start over with a new name
+                std::cout << "ERROR::STREAM_BUFFER::PERSISTENT_MAP_FAILED" << std::endl;
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                glDeleteBuffers(1, &ID);
+                glGenBuffers(1, &ID);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+                persistentMapping = false;
+            }
+        }
+        if (!persistentMapping)
+            glBufferData(GL_COPY_WRITE_BUFFER, frameSize, NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    // start writing a frame
+    // ------------------------------------------------------------------------
+    void begin()
+    {
+        head = 0;
+        mappedFrom = 0;
+        recording = true;
+        if (persistentMapping)
+        {
+            waitFor(region);
+            mapped = base + region * frameSize;
+            return;
+        }
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        // orphan: same name, new storage, no wait on last frame's draws
+        glBufferData(GL_COPY_WRITE_BUFFER, frameSize, NULL, GL_STREAM_DRAW);
+        mapped = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, frameSize,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    // size bytes at an offset that is a multiple of alignment, which may be a
+    // vertex stride so offset / stride is the first vertex of the draw. the
+    // offset from the start of ID is aligned, not the one within the region,
+    // frameSize need not be a multiple of the stride
+    // ------------------------------------------------------------------------
+    Allocation allocate(size_t size, size_t alignment = 16)
+    {
+        Allocation allocation;
+        size_t regionStart = persistentMapping ? region * frameSize : 0;
+        size_t start = head;
+        if (alignment)
+            start = (regionStart + head + alignment - 1) / alignment * alignment - regionStart;
+        if (!recording || start >= frameSize || size > frameSize - start || (!mapped && !remap(start)))
+        {
+            stat.overflows++;
+            return allocation;
+        }
+        allocation.data = mapped + (start - mappedFrom);
+        allocation.offset = regionStart + start;
+        head = start + size;
+        stat.bytes += size;
+        return allocation;
+    }
+    // writes so far are done, draws may read them now. the coherent mapping
+    // needs nothing, the fallback has to unmap before drawing and maps the
+    // rest of the frame again on the next allocate
+    // ------------------------------------------------------------------------
+    void commit()
+    {
+        if (persistentMapping || !mapped)
+            return;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        mapped = NULL;
+    }
+    // after the last draw that reads this frame's data
+    // ------------------------------------------------------------------------
+    void end()
+    {
+        commit();
+        recording = false;
+        if (persistentMapping)
+        {
+            fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            region = (region + 1) % FRAMES;
+            mapped = NULL;
+        }
+        stat.frames++;
+    }
+    // ------------------------------------------------------------------------
+    bool persistent() const
+    {
+        return persistentMapping;
+    }
+    const Stats& stats() const
+    {
+        return stat;
+    }
+    // unmaps and deletes the buffer, with the context still current
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (unsigned int i = 0; i < FRAMES; i++)
+        {
+            if (fences[i])
+                glDeleteSync(fences[i]);
+            fences[i] = NULL;
+        }
+        if (base || mapped)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &ID);
+        ID = 0;
+        base = mapped = NULL;
+    }
+
+private:
+    size_t frameSize;
+    unsigned int region;
+    size_t head;
+    char* base;
+    char* mapped;
+    size_t mappedFrom;  // frame offset mapped points at
+    GLsync fences[FRAMES];
+    bool persistentMapping;
+    bool recording;     // between begin() and end()
+    Stats stat;
+
+    // fallback only: [from, frameSize) after a commit. draws issued since
+    // begin() read below head <= from, so nothing has to be waited for
+    // ------------------------------------------------------------------------
+    bool remap(size_t from)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        mapped = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, from, frameSize - from,
+                                         GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        mappedFrom = from;
+        if (!mapped)
+            std::cout << "ERROR::STREAM_BUFFER::REMAP_FAILED" << std::endl;
+        return mapped != NULL;
+    }
+
+    // ------------------------------------------------------------------------
+    void waitFor(unsigned int index)
+    {
+        if (!fences[index])
+            return;
+        GLenum result = glClientWaitSync(fences[index], 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED)
+        {
+            stat.stalls++;
+            // flush so the fence is guaranteed to signal, then block
+            do
+            {
+                result = glClientWaitSync(fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            } while (result == GL_TIMEOUT_EXPIRED);
+        }
+        glDeleteSync(fences[index]);
+        fences[index] = NULL;
+    }
+};
+
+#endif /* StreamBuffer_h */
@@ -0,0 +1,204 @@
+//
+//  EntityStore.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef EntityStore_h
+#define EntityStore_h
+
+#include <vector>
+#include <iostream>
+
+#include "TransformBatch.h"
+
+// scene objects as dense component arrays, one element per live entity and
+// the same index in every array, so a system walks only the arrays it needs
+// front to back. transforms holds position, rotation (axis + angle) and
+// scale in the layout TransformBatch reads; spin, mesh and material sit
+// beside it.
+//
+//   EntityStore scene;
+//   unsigned int cube = scene.create();
+//   scene.transforms.set(scene.index(cube), position, axis, 0.0f);
+//   scene.spin[scene.index(cube)] = glm::radians(20.0f);
+//   ...
+//   scene.destroy(cube);
+//
+// destroy moves the last entity into the hole, so indices change; handles
+// do not, and a destroyed entity's handle stays invalid while its slot is
+// reused, for 255 reuses. arrays may be written in place but never resized
+// directly.
+class EntityStore
+{
+public:
+    static const unsigned int INVALID = 0xFFFFFFFF;
+    // handles are slot | generation << SLOT_BITS
+    static const unsigned int SLOT_BITS = 24;
+    // the top slot stays unused so no handle equals INVALID
+    static const unsigned int MAX_ENTITIES = (1u << SLOT_BITS) - 1;
+
+    TransformSoA transforms;
+    std::vector<float> spin;                // radians per second around the rotation axis
+    std::vector<unsigned short> mesh;
+    std::vector<unsigned short> material;
+
+    // ------------------------------------------------------------------------
+    void reserve(size_t count)
+    {
+        transforms.x.reserve(count);
+        transforms.y.reserve(count);
+        transforms.z.reserve(count);
+        transforms.axisX.reserve(count);
+        transforms.axisY.reserve(count);
+        transforms.axisZ.reserve(count);
+        transforms.angle.reserve(count);
+        transforms.scale.reserve(count);
+        spin.reserve(count);
+        mesh.reserve(count);
+        material.reserve(count);
+        slotOf.reserve(count);
+    }
+    // new entity at index size() - 1: at the origin, unrotated around +y,
+    // scale 1, mesh and material 0. INVALID when the store is full
+    // ------------------------------------------------------------------------
+    unsigned int create()
+    {
+        unsigned int slot;
+        if (!freeSlots.empty())
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else
+        {
+            if (slots.size() == MAX_ENTITIES)
+            {
+                std::cout << "ERROR::ENTITY_STORE::FULL" << std::endl;
+                return INVALID;
+            }
+            slot = (unsigned int)slots.size();
+            slots.push_back(Slot());
+        }
+
+        size_t index = size();
+        const float origin[3] = { 0.0f, 0.0f, 0.0f };
+        const float up[3] = { 0.0f, 1.0f, 0.0f };
+        transforms.resize(index + 1);
+        transforms.set(index, origin, up, 0.0f);
+        spin.push_back(0.0f);
+        mesh.push_back(0);
+        material.push_back(0);
+        slotOf.push_back(slot);
+        slots[slot].index = (unsigned int)index;
+        return handle(slot);
+    }
+    // swap-remove: the last entity moves into index(entity)
+    // ------------------------------------------------------------------------
+    void destroy(unsigned int entity)
+    {
+        if (!alive(entity))
+            return;
+        unsigned int slot = entity & SLOT_MASK;
+        size_t index = slots[slot].index;
+        size_t last = size() - 1;
+        if (index != last)
+        {
+            move(last, index);
+            slots[slotOf[index]].index = (unsigned int)index;
+        }
+        pop();
+
+        slots[slot].index = DEAD;
+        slots[slot].generation++;
+        freeSlots.push_back(slot);
+    }
+    // ------------------------------------------------------------------------
+    bool alive(unsigned int entity) const
+    {
+        unsigned int slot = entity & SLOT_MASK;
+        return entity != INVALID && slot < slots.size() && slots[slot].index != DEAD
+            && (slots[slot].generation & 0xFF) == entity >> SLOT_BITS;
+    }
+    // position in the component arrays, INVALID for a dead handle
+    unsigned int index(unsigned int entity) const
+    {
+        if (!alive(entity))
+            return INVALID;
+        return slots[entity & SLOT_MASK].index;
+    }
+    // handle of whatever sits at index now
+    unsigned int entity(size_t index) const
+    {
+        return handle(slotOf[index]);
+    }
+    size_t size() const
+    {
+        return slotOf.size();
+    }
+    // ------------------------------------------------------------------------
+    void clear()
+    {
+        transforms.resize(0);
+        spin.clear();
+        mesh.clear();
+        material.clear();
+        // bump every live slot so outstanding handles die with the entities
+        for (unsigned int slot : slotOf)
+        {
+            slots[slot].index = DEAD;
+            slots[slot].generation++;
+            freeSlots.push_back(slot);
+        }
+        slotOf.clear();
+    }
+
+private:
+    static const unsigned int SLOT_MASK = (1u << SLOT_BITS) - 1;
+    static const unsigned int DEAD = 0xFFFFFFFF;
+
+    struct Slot
+    {
+        unsigned int index = 0;
+        unsigned int generation = 0;    // low 8 bits end up in the handle
+    };
+
+    std::vector<Slot> slots;            // per handle slot
+    std::vector<unsigned int> freeSlots;
+    std::vector<unsigned int> slotOf;   // per index, the slot that owns it
+
+    // ------------------------------------------------------------------------
+    unsigned int handle(unsigned int slot) const
+    {
+        return slot | (slots[slot].generation & 0xFF) << SLOT_BITS;
+    }
+    // component row from to row to, every array
+    // ------------------------------------------------------------------------
+    void move(size_t from, size_t to)
+    {
+        transforms.x[to] = transforms.x[from];
+        transforms.y[to] = transforms.y[from];
+        transforms.z[to] = transforms.z[from];
+        transforms.axisX[to] = transforms.axisX[from];
+        transforms.axisY[to] = transforms.axisY[from];
+        transforms.axisZ[to] = transforms.axisZ[from];
+        transforms.angle[to] = transforms.angle[from];
+        transforms.scale[to] = transforms.scale[from];
+        spin[to] = spin[from];
+        mesh[to] = mesh[from];
+        material[to] = material[from];
+        slotOf[to] = slotOf[from];
+    }
+    // ------------------------------------------------------------------------
+    void pop()
+    {
+        transforms.resize(size() - 1);
+        spin.pop_back();
+        mesh.pop_back();
+        material.pop_back();
+        slotOf.pop_back();
+    }
+};
+
+#endif /* EntityStore_h */
@@ -0,0 +1,69 @@
+//
+//  CameraBuffer.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef CameraBuffer_h
+#define CameraBuffer_h
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+#include "Shader.h"
+
+// std140 mirror of the Camera block, mat4 columns need no padding
+//
+//   layout (std140) uniform Camera
+//   {
+//       mat4 view;
+//       mat4 projection;
+//   };
+struct CameraBlock
+{
+    float view[16];
+    float projection[16];
+};
+
+// one uniform buffer holding the per-frame camera, bound at a fixed binding
+// point and shared by every program that declares the Camera block. create it
+// before the shaders so they pick the binding up after link.
+class CameraBuffer
+{
+public:
+    static const unsigned int BINDING = 0;
+    unsigned int ID;
+
+    CameraBuffer()
+    {
+        memset(&block, 0, sizeof(block));
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, ID);
+        Shader::registerUniformBlock("Camera", BINDING);
+    }
+    // write the camera once per frame, skipped when nothing moved
+    // ------------------------------------------------------------------------
+    void update(const float* view, const float* projection)
+    {
+        if (written && memcmp(block.view, view, sizeof(block.view)) == 0
+            && memcmp(block.projection, projection, sizeof(block.projection)) == 0)
+            return;
+        memcpy(block.view, view, sizeof(block.view));
+        memcpy(block.projection, projection, sizeof(block.projection));
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        written = true;
+    }
+
+private:
+    CameraBlock block;
+    bool written = false;
+};
+
+#endif /* CameraBuffer_h */
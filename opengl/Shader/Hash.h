@@ -0,0 +1,39 @@
+//
+//  Hash.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef Hash_h
+#define Hash_h
+
+#include <cstddef>
+
+// 64 bit FNV-1a. constexpr so string literals can be hashed at compile time.
+// ------------------------------------------------------------------------
+const unsigned long long FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const unsigned long long FNV_PRIME = 1099511628211ULL;
+
+constexpr unsigned long long fnv1a(const char* data, size_t length, unsigned long long hash = FNV_OFFSET_BASIS)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+constexpr unsigned long long fnv1a(const char* str)
+{
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    for (; *str; str++)
+    {
+        hash ^= (unsigned char)*str;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+#endif /* Hash_h */
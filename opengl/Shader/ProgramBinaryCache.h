@@ -0,0 +1,215 @@
+//
+//  ProgramBinaryCache.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef ProgramBinaryCache_h
+#define ProgramBinaryCache_h
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+
+#include "GLExtensions.h"
+#include "Hash.h"
+
+// on-disk cache of linked programs (glGetProgramBinary / glProgramBinary).
+// entries are keyed by the shader sources plus the driver vendor, renderer and
+// version strings, so a driver update simply misses instead of loading a blob
+// the driver no longer understands. pass one to the Shader constructor to opt in.
+class ProgramBinaryCache
+{
+public:
+    struct Stats
+    {
+        unsigned int hits = 0;
+        unsigned int misses = 0;
+        unsigned int rejected = 0;   // blob found but the driver refused it
+        unsigned int stored = 0;
+        double loadMs = 0.0;         // time spent in glProgramBinary for hits
+        double buildMs = 0.0;        // time spent compiling and linking misses
+    };
+
+    ProgramBinaryCache(const char* directory)
+        : dir(directory)
+    {
+        driverHash = FNV_OFFSET_BASIS;
+        const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+        for (GLenum name : strings)
+        {
+            const char* value = (const char*)glGetString(name);
+            if (value)
+                driverHash = fnv1a(value, strlen(value), driverHash);
+        }
+        unsigned int formatVersion = FORMAT_VERSION;
+        driverHash = fnv1a((const char*)&formatVersion, sizeof(formatVersion), driverHash);
+
+        int formats = 0;
+        if (glext().programBinary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        available = formats > 0;
+        if (available)
+            mkdir(dir.c_str(), 0755);
+    }
+
+    bool enabled() const
+    {
+        return available;
+    }
+    // key for a vertex/fragment pair on the current driver
+    // ------------------------------------------------------------------------
+    unsigned long long key(const char* vertexCode, size_t vertexLength, const char* fragmentCode, size_t fragmentLength) const
+    {
+        unsigned long long hash = fnv1a(vertexCode, vertexLength, driverHash);
+        // separator so moving text between the two stages changes the key
+        hash = fnv1a("\0", 1, hash);
+        return fnv1a(fragmentCode, fragmentLength, hash);
+    }
+    // try to restore program from the cache. returns true when program is
+    // linked and ready to use, false means the caller has to build it.
+    // ------------------------------------------------------------------------
+    bool load(unsigned int program, unsigned long long key)
+    {
+        if (!available)
+            return false;
+
+        auto start = std::chrono::steady_clock::now();
+        std::string path = pathFor(key);
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file)
+        {
+            stat.misses++;
+            return false;
+        }
+
+        Header header;
+        std::vector<char> binary;
+        bool ok = fread(&header, sizeof(header), 1, file) == 1
+            && header.magic == MAGIC && header.key == key && header.length > 0;
+        if (ok)
+        {
+            binary.resize(header.length);
+            ok = fread(binary.data(), 1, binary.size(), file) == binary.size();
+        }
+        fclose(file);
+        if (!ok)
+        {
+            // truncated or written by a different build, treat as stale
+            stat.misses++;
+            remove(path.c_str());
+            return false;
+        }
+
+        glext().ProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            stat.rejected++;
+            stat.misses++;
+            remove(path.c_str());
+            return false;
+        }
+
+        stat.hits++;
+        stat.loadMs += elapsedMs(start);
+        return true;
+    }
+    // must be called before glLinkProgram so the driver keeps the binary around
+    // ------------------------------------------------------------------------
+    void prepare(unsigned int program)
+    {
+        if (available)
+            glext().ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    // write a freshly linked program back to disk
+    // ------------------------------------------------------------------------
+    void store(unsigned int program, unsigned long long key)
+    {
+        if (!available)
+            return;
+
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<char> binary(length);
+        Header header;
+        header.magic = MAGIC;
+        header.key = key;
+        glext().GetProgramBinary(program, length, NULL, &header.format, binary.data());
+        header.length = (unsigned int)length;
+
+        // write to a temp file and rename, a crash never leaves a torn entry
+        std::string path = pathFor(key);
+        std::string temp = path + ".tmp";
+        FILE* file = fopen(temp.c_str(), "wb");
+        if (!file)
+            return;
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+            && fwrite(binary.data(), 1, binary.size(), file) == binary.size();
+        ok = fclose(file) == 0 && ok;
+        if (ok && rename(temp.c_str(), path.c_str()) == 0)
+            stat.stored++;
+        else
+            remove(temp.c_str());
+    }
+    // ------------------------------------------------------------------------
+    void recordBuild(double ms)
+    {
+        stat.buildMs += ms;
+    }
+    // ------------------------------------------------------------------------
+    const Stats& stats() const
+    {
+        return stat;
+    }
+    // ------------------------------------------------------------------------
+    void printStats() const
+    {
+        std::cout << "PROGRAM_BINARY_CACHE: " << (available ? "enabled" : "unsupported by driver")
+                  << " hits=" << stat.hits << " misses=" << stat.misses
+                  << " rejected=" << stat.rejected << " stored=" << stat.stored
+                  << " load=" << stat.loadMs << "ms build=" << stat.buildMs << "ms" << std::endl;
+    }
+
+    static double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    static const unsigned int MAGIC = 0x31434250; // "PBC1"
+    static const unsigned int FORMAT_VERSION = 1;
+
+    struct Header
+    {
+        unsigned int magic = 0;
+        GLenum format = 0;
+        unsigned int length = 0;
+        unsigned long long key = 0;
+    };
+
+    std::string dir;
+    unsigned long long driverHash;
+    bool available;
+    Stats stat;
+
+    std::string pathFor(unsigned long long key) const
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "/%016llx.bin", key);
+        return dir + name;
+    }
+};
+
+#endif /* ProgramBinaryCache_h */
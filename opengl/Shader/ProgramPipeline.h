@@ -0,0 +1,173 @@
+//
+//  ProgramPipeline.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef ProgramPipeline_h
+#define ProgramPipeline_h
+
+#include <glad/glad.h>
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <iostream>
+
+#include "GLExtensions.h"
+#include "ShaderSource.h"
+#include "Hash.h"
+#include "GLState.h"
+
+inline bool checkProgramLink(unsigned int program)
+{
+    int success = 0;
+    char infoLog[1024];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(program, 1024, NULL, infoLog);
+        std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: PROGRAM\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+    }
+    return success != 0;
+}
+
+// a single vertex or fragment stage, compiled once. with separate shader
+// objects it is also linked on its own into a GL_PROGRAM_SEPARABLE program,
+// otherwise the compiled shader object is kept for linking into full programs.
+class ShaderStage
+{
+public:
+    GLenum type;
+    unsigned int shader = 0;   // shader object, only kept on the fallback path
+    unsigned int program = 0;  // separable program, 0 on the fallback path
+    bool ok = false;
+
+    ShaderStage(GLenum type, ShaderSource source)
+        : type(type)
+    {
+        shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source.data, &source.length);
+        glCompileShader(shader);
+        int success = 0;
+        char infoLog[1024];
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+            std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT") << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            return;
+        }
+        ok = true;
+        if (!glext().separateShaderObjects)
+            return;
+
+        program = glCreateProgram();
+        glext().ProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        glAttachShader(program, shader);
+        glLinkProgram(program);
+        glDetachShader(program, shader);
+        glDeleteShader(shader);
+        shader = 0;
+        ok = checkProgramLink(program);
+    }
+};
+
+// mixes vertex and fragment stages at draw time. with GL 4.1 or
+// ARB_separate_shader_objects every stage is linked once and a pipeline object
+// per combination just points at them, so V vertex and F fragment stages cost
+// V + F links instead of V x F. without it each combination that is actually
+// bound gets a regular program, linked the first time it is used.
+//
+//   ProgramPipelines pipelines;
+//   ShaderStage& vs = pipelines.stage(GL_VERTEX_SHADER, vertexSource);
+//   ShaderStage& fs = pipelines.stage(GL_FRAGMENT_SHADER, fragmentSource);
+//   pipelines.bind(vs, fs);
+class ProgramPipelines
+{
+public:
+    struct Stats
+    {
+        unsigned int stages = 0;
+        unsigned int reused = 0;     // stage() calls answered from the cache
+        unsigned int links = 0;
+        unsigned int pipelines = 0;  // pipeline objects or fallback programs
+    };
+
+    // owned by this object, the reference stays valid for its lifetime. stages
+    // are keyed by type and a hash of the source text, asking again for the same
+    // text returns the stage that was already compiled.
+    // ------------------------------------------------------------------------
+    ShaderStage& stage(GLenum type, ShaderSource source)
+    {
+        unsigned long long key = fnv1a(source.data, source.length);
+        key = fnv1a((const char*)&type, sizeof(type), key);
+        std::unique_ptr<ShaderStage>& stage = stages[key];
+        if (stage)
+        {
+            stat.reused++;
+            return *stage;
+        }
+        stage.reset(new ShaderStage(type, source));
+        stat.stages++;
+        if (stage->program)
+            stat.links++;
+        return *stage;
+    }
+    // make the combination current for the following draws
+    // ------------------------------------------------------------------------
+    void bind(const ShaderStage& vertex, const ShaderStage& fragment)
+    {
+        use(object(vertex, fragment));
+    }
+    // the pipeline object, or the fallback program, for the combination.
+    // created on first use, bind it later with use()
+    // ------------------------------------------------------------------------
+    unsigned int object(const ShaderStage& vertex, const ShaderStage& fragment)
+    {
+        unsigned int& object = combinations[std::make_pair(&vertex, &fragment)];
+        if (object)
+            return object;
+
+        if (glext().separateShaderObjects)
+        {
+            glext().GenProgramPipelines(1, &object);
+            glext().UseProgramStages(object, GL_VERTEX_SHADER_BIT, vertex.program);
+            glext().UseProgramStages(object, GL_FRAGMENT_SHADER_BIT, fragment.program);
+        }
+        else
+        {
+            object = glCreateProgram();
+            glAttachShader(object, vertex.shader);
+            glAttachShader(object, fragment.shader);
+            glLinkProgram(object);
+            glDetachShader(object, vertex.shader);
+            glDetachShader(object, fragment.shader);
+            checkProgramLink(object);
+            stat.links++;
+        }
+        stat.pipelines++;
+        return object;
+    }
+    // ------------------------------------------------------------------------
+    static void use(unsigned int object)
+    {
+        if (glext().separateShaderObjects)
+            glstate().bindProgramPipeline(object);
+        else
+            glstate().useProgram(object);
+    }
+    // ------------------------------------------------------------------------
+    const Stats& stats() const
+    {
+        return stat;
+    }
+
+private:
+    std::map<unsigned long long, std::unique_ptr<ShaderStage> > stages;
+    std::map<std::pair<const ShaderStage*, const ShaderStage*>, unsigned int> combinations;
+    Stats stat;
+};
+
+#endif /* ProgramPipeline_h */
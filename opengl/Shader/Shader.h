@@ -11,97 +11,504 @@
 #include <glad/glad.h>
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <chrono>
+#include <cstring>
+
+#include "ProgramBinaryCache.h"
+#include "ShaderSource.h"
+#include "MappedFile.h"
+#include "Hash.h"
+#include "GLState.h"
+
+// a uniform resolved once after link. setting through a handle does no string
+// work and no driver query, resolve handles outside the render loop.
+struct UniformHandle
+{
+    int slot = -1;
+
+    bool valid() const
+    {
+        return slot >= 0;
+    }
+};
+
+// glUniform* calls made vs. skipped because the program already held the value
+struct UniformStats
+{
+    unsigned int issued = 0;
+    unsigned int elided = 0;
+
+    void reset()
+    {
+        issued = 0;
+        elided = 0;
+    }
+};
 
 class Shader
 {
 public:
     unsigned int ID;
-    // constructor generates the shader on the fly
+    // empty shader, built later with beginBuild/endBuild (see ShaderBatch)
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath)
+    Shader()
+        : ID(0)
     {
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
+    }
+    // constructor generates the shader on the fly. with a cache the linked
+    // program is restored from disk when the sources and driver still match.
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const char* fragmentPath, ProgramBinaryCache* cache = NULL)
+    {
+        // 1. map the vertex/fragment source files, the driver reads them in place
+        MappedFile vertexFile(vertexPath);
+        MappedFile fragmentFile(fragmentPath);
+        if (!vertexFile.isOpen() || !fragmentFile.isOpen())
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << (vertexFile.isOpen() ? fragmentPath : vertexPath) << std::endl;
+            ID = 0;
+            return;
+        }
+        // 2. compile and link, checking the result right away
+        beginBuild(ShaderSource(vertexFile.data(), vertexFile.size()),
+                   ShaderSource(fragmentFile.data(), fragmentFile.size()), cache);
+        endBuild();
+    }
+    // sources compiled into the binary, no file system access at all
+    // ------------------------------------------------------------------------
+    Shader(ShaderSource vertexSource, ShaderSource fragmentSource, ProgramBinaryCache* cache = NULL)
+    {
+        beginBuild(vertexSource, fragmentSource, cache);
+        endBuild();
+    }
+    // ------------------------------------------------------------------------
+    static bool readFile(const char* path, std::string& code)
+    {
+        std::ifstream file;
         // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+        file.exceptions (std::ifstream::failbit | std::ifstream::badbit);
         try
         {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode   = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            file.close();
+            code = stream.str();
         }
         catch (std::ifstream::failure& e)
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
+            return false;
+        }
+        return true;
+    }
+    // split build. beginBuild only issues the compile and link commands and
+    // reads no status back, so the driver is free to compile in the background.
+    // endBuild checks the results, reports errors and reflects the uniforms.
+    // ------------------------------------------------------------------------
+    void beginBuild(ShaderSource vertexSource, ShaderSource fragmentSource, ProgramBinaryCache* cache = NULL)
+    {
+        ID = glCreateProgram();
+        pending = BuildState();
+        pending.cache = cache;
+        if (cache && cache->enabled())
+        {
+            pending.cacheKey = cache->key(vertexSource.data, vertexSource.length, fragmentSource.data, fragmentSource.length);
+            pending.restored = cache->load(ID, pending.cacheKey);
+            if (pending.restored)
+                return;
+        }
+        pending.start = std::chrono::steady_clock::now();
+        // vertex shader, explicit lengths so the text needs no terminating NUL
+        pending.vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(pending.vertex, 1, &vertexSource.data, &vertexSource.length);
+        glCompileShader(pending.vertex);
         // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+        pending.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(pending.fragment, 1, &fragmentSource.data, &fragmentSource.length);
+        glCompileShader(pending.fragment);
         // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
+        glAttachShader(ID, pending.vertex);
+        glAttachShader(ID, pending.fragment);
+        if (cache)
+            cache->prepare(ID);
         glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+    }
+    // true once endBuild will not block. only answers early with
+    // KHR/ARB_parallel_shader_compile, otherwise it is always true.
+    // ------------------------------------------------------------------------
+    bool buildComplete() const
+    {
+        if (pending.restored || !glext().parallelShaderCompile)
+            return true;
+        int done = 0;
+        glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+        return done != 0;
+    }
+    // ------------------------------------------------------------------------
+    bool endBuild()
+    {
+        bool linked = pending.restored;
+        if (!pending.restored)
+        {
+            checkCompileErrors(pending.vertex, "VERTEX");
+            checkCompileErrors(pending.fragment, "FRAGMENT");
+            linked = checkCompileErrors(ID, "PROGRAM");
+            // delete the shaders as they're linked into our program now and no longer necessary
+            glDeleteShader(pending.vertex);
+            glDeleteShader(pending.fragment);
+            if (pending.cache && pending.cache->enabled() && linked)
+            {
+                pending.cache->recordBuild(ProgramBinaryCache::elapsedMs(pending.start));
+                pending.cache->store(ID, pending.cacheKey);
+            }
+        }
+        pending = BuildState();
+        if (linked)
+        {
+            reflectUniforms();
+            bindUniformBlocks();
+        }
+        return linked;
     }
     // activate the shader
     // ------------------------------------------------------------------------
     void use()
     {
-        glUseProgram(ID);
+        glstate().useProgram(ID);
+    }
+    // rebuild from new sources. on success the new program replaces ID, handles
+    // stay valid and every shadowed uniform value (sampler units included) is
+    // uploaded again. on a compile or link error the old program stays in use.
+    // ------------------------------------------------------------------------
+    bool reload(ShaderSource vertexSource, ShaderSource fragmentSource)
+    {
+        unsigned int previous = ID;
+        beginBuild(vertexSource, fragmentSource);
+        if (!endBuild())
+        {
+            glDeleteProgram(ID);
+            ID = previous;
+            return false;
+        }
+
+        unsigned int current = glstate().currentProgram();
+        glstate().useProgram(ID);
+        for (const UniformInfo& info : uniforms)
+        {
+            if (info.location >= 0 && info.shadowValid)
+                uploadShadow(info);
+        }
+        if (current != previous)
+            glstate().useProgram(current);
+        glDeleteProgram(previous);
+        return true;
+    }
+    // look up an active uniform by name. arrays are found by their plain name
+    // as well as "name[0]". returns an invalid handle if the uniform is not
+    // active, setting through it is a no-op like location -1.
+    // ------------------------------------------------------------------------
+    UniformHandle uniform(const char* name) const
+    {
+        return findUniform(fnv1a(name));
+    }
+    // ------------------------------------------------------------------------
+    UniformHandle findUniform(unsigned long long hash) const
+    {
+        UniformHandle handle;
+        if (buckets.empty())
+            return handle;
+        size_t mask = buckets.size() - 1;
+        for (size_t i = (size_t)hash & mask; buckets[i].slot >= 0; i = (i + 1) & mask)
+        {
+            if (buckets[i].hash == hash)
+            {
+                handle.slot = buckets[i].slot;
+                break;
+            }
+        }
+        return handle;
+    }
+    // ------------------------------------------------------------------------
+    int location(UniformHandle handle) const
+    {
+        return handle.valid() ? uniforms[handle.slot].location : -1;
+    }
+    // ------------------------------------------------------------------------
+    GLenum uniformType(UniformHandle handle) const
+    {
+        return handle.valid() ? uniforms[handle.slot].type : GL_NONE;
+    }
+    // every program declaring a uniform block with this name gets it bound to
+    // binding, register before creating the shaders that use it
+    // ------------------------------------------------------------------------
+    static void registerUniformBlock(const char* name, unsigned int binding)
+    {
+        std::vector<UniformBlockBinding>& blocks = uniformBlockBindings();
+        for (UniformBlockBinding& block : blocks)
+        {
+            if (block.name == name)
+            {
+                block.binding = binding;
+                return;
+            }
+        }
+        UniformBlockBinding block = { name, binding };
+        blocks.push_back(block);
+    }
+    // uploads made by this program since it was created
+    // ------------------------------------------------------------------------
+    const UniformStats& uniformStats() const
+    {
+        return totalStats;
+    }
+    // uploads made by all programs, reset it at the start of every frame
+    // ------------------------------------------------------------------------
+    static UniformStats& frameStats()
+    {
+        static UniformStats stats;
+        return stats;
+    }
+    // record value as the uniform's current value. returns false when the
+    // program already holds exactly these bytes and the upload can be skipped.
+    // the setters below and Uniform<T> go through here before calling glUniform*
+    // ------------------------------------------------------------------------
+    bool shadow(UniformHandle handle, const void* value, size_t size) const
+    {
+        if (!handle.valid())
+            return false;
+        UniformInfo& info = uniforms[handle.slot];
+        if (info.shadowValid && memcmp(info.shadowValue, value, size) == 0)
+        {
+            totalStats.elided++;
+            frameStats().elided++;
+            return false;
+        }
+        memcpy(info.shadowValue, value, size);
+        info.shadowValid = true;
+        totalStats.issued++;
+        frameStats().issued++;
+        return true;
+    }
+    // utility uniform functions. every value is shadowed on the CPU and the
+    // glUniform* call is skipped when the program already holds the same bits,
+    // so don't mix these with raw glUniform* calls on the same program.
+    // ------------------------------------------------------------------------
+    void setBool(UniformHandle handle, bool value) const
+    {
+        int v = (int)value;
+        if (shadow(handle, &v, sizeof(v)))
+            glUniform1i(location(handle), v);
+    }
+    // ------------------------------------------------------------------------
+    void setInt(UniformHandle handle, int value) const
+    {
+        if (shadow(handle, &value, sizeof(value)))
+            glUniform1i(location(handle), value);
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(UniformHandle handle, float value) const
+    {
+        if (shadow(handle, &value, sizeof(value)))
+            glUniform1f(location(handle), value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec2(UniformHandle handle, float x, float y) const
+    {
+        const float v[2] = { x, y };
+        if (shadow(handle, v, sizeof(v)))
+            glUniform2fv(location(handle), 1, v);
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(UniformHandle handle, float x, float y, float z, float w) const
+    {
+        const float v[4] = { x, y, z, w };
+        if (shadow(handle, v, sizeof(v)))
+            glUniform4fv(location(handle), 1, v);
+    }
+    // ------------------------------------------------------------------------
+    void setMat4(UniformHandle handle, const float* value) const
+    {
+        if (shadow(handle, value, 16 * sizeof(float)))
+            glUniformMatrix4fv(location(handle), 1, GL_FALSE, value);
+    }
+    // by name, still a hashed table lookup but no driver query
+    // ------------------------------------------------------------------------
+    void setBool(const char* name, bool value) const
+    {
+        setBool(uniform(name), value);
     }
-    // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        setBool(uniform(name.c_str()), value);
+    }
+    // ------------------------------------------------------------------------
+    void setInt(const char* name, int value) const
+    {
+        setInt(uniform(name), value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        setInt(uniform(name.c_str()), value);
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(const char* name, float value) const
+    {
+        setFloat(uniform(name), value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        setFloat(uniform(name.c_str()), value);
     }
 
 private:
+    struct UniformInfo
+    {
+        std::string name;
+        int location;
+        GLenum type;
+        int size;
+        // last value uploaded to element 0, big enough for a mat4
+        bool shadowValid;
+        unsigned char shadowValue[16 * sizeof(float)];
+    };
+    struct UniformBlockBinding
+    {
+        std::string name;
+        unsigned int binding;
+    };
+    struct UniformBucket
+    {
+        unsigned long long hash;
+        int slot;
+    };
+    // flat table of active uniforms, buckets is an open addressing index into it
+    mutable std::vector<UniformInfo> uniforms;
+    std::vector<UniformBucket> buckets;
+    mutable UniformStats totalStats;
+
+    // in flight between beginBuild and endBuild
+    struct BuildState
+    {
+        unsigned int vertex = 0;
+        unsigned int fragment = 0;
+        bool restored = false;
+        ProgramBinaryCache* cache = NULL;
+        unsigned long long cacheKey = 0;
+        std::chrono::steady_clock::time_point start;
+    };
+    BuildState pending;
+
+    // enumerate the active uniforms once after link
+    // ------------------------------------------------------------------------
+    void reflectUniforms()
+    {
+        // uniforms that survive a reload keep their slot so handles stay valid,
+        // ones that disappeared keep it too but with location -1
+        for (UniformInfo& info : uniforms)
+            info.location = -1;
+        int count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> nameBuffer(maxLength + 1);
+        for (int i = 0; i < count; i++)
+        {
+            UniformInfo info;
+            info.shadowValid = false;
+            GLsizei length = 0;
+            glGetActiveUniform(ID, i, (GLsizei)nameBuffer.size(), &length, &info.size, &info.type, nameBuffer.data());
+            info.name.assign(nameBuffer.data(), length);
+            info.location = glGetUniformLocation(ID, info.name.c_str());
+            // members of uniform blocks have no location
+            if (info.location < 0)
+                continue;
+            UniformHandle existing = findUniform(fnv1a(info.name.c_str()));
+            if (existing.valid())
+            {
+                UniformInfo& old = uniforms[existing.slot];
+                if (old.type != info.type)
+                    old.shadowValid = false;
+                old.location = info.location;
+                old.type = info.type;
+                old.size = info.size;
+            }
+            else
+            {
+                uniforms.push_back(info);
+            }
+        }
+
+        // two names per uniform at most, keep the load factor under one half
+        size_t capacity = 8;
+        while (capacity < uniforms.size() * 4)
+            capacity *= 2;
+        UniformBucket empty = { 0, -1 };
+        buckets.assign(capacity, empty);
+        for (size_t slot = 0; slot < uniforms.size(); slot++)
+        {
+            const std::string& name = uniforms[slot].name;
+            insertBucket(fnv1a(name.c_str()), (int)slot);
+            // arrays are reported as "name[0]", make them reachable as "name" too
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+                insertBucket(fnv1a(name.c_str(), name.size() - 3), (int)slot);
+        }
+    }
+    // re-issue a shadowed value, used when a reload swaps the program
+    // ------------------------------------------------------------------------
+    void uploadShadow(const UniformInfo& info) const
+    {
+        float f[16];
+        int i;
+        memcpy(f, info.shadowValue, sizeof(f));
+        memcpy(&i, info.shadowValue, sizeof(i));
+        switch (info.type)
+        {
+            case GL_FLOAT:      glUniform1fv(info.location, 1, f); break;
+            case GL_FLOAT_VEC2: glUniform2fv(info.location, 1, f); break;
+            case GL_FLOAT_VEC3: glUniform3fv(info.location, 1, f); break;
+            case GL_FLOAT_VEC4: glUniform4fv(info.location, 1, f); break;
+            case GL_FLOAT_MAT3: glUniformMatrix3fv(info.location, 1, GL_FALSE, f); break;
+            case GL_FLOAT_MAT4: glUniformMatrix4fv(info.location, 1, GL_FALSE, f); break;
+            // int, bool and the sampler types
+            default:            glUniform1i(info.location, i); break;
+        }
+    }
+    // ------------------------------------------------------------------------
+    static std::vector<UniformBlockBinding>& uniformBlockBindings()
+    {
+        static std::vector<UniformBlockBinding> blocks;
+        return blocks;
+    }
+    // attach the registered uniform blocks this program declares
+    // ------------------------------------------------------------------------
+    void bindUniformBlocks()
+    {
+        for (const UniformBlockBinding& block : uniformBlockBindings())
+        {
+            unsigned int index = glGetUniformBlockIndex(ID, block.name.c_str());
+            if (index != GL_INVALID_INDEX)
+                glUniformBlockBinding(ID, index, block.binding);
+        }
+    }
+    // ------------------------------------------------------------------------
+    void insertBucket(unsigned long long hash, int slot)
+    {
+        size_t mask = buckets.size() - 1;
+        size_t i = (size_t)hash & mask;
+        while (buckets[i].slot >= 0)
+            i = (i + 1) & mask;
+        buckets[i].hash = hash;
+        buckets[i].slot = slot;
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(unsigned int shader, std::string type)
+    bool checkCompileErrors(unsigned int shader, std::string type)
     {
         int success;
         char infoLog[1024];
@@ -123,6 +530,7 @@ private:
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
 
@@ -0,0 +1,131 @@
+//
+//  ShaderBatch.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef ShaderBatch_h
+#define ShaderBatch_h
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "GLExtensions.h"
+#include "MappedFile.h"
+#include "Shader.h"
+
+// builds many shaders at once. submit() issues every compile and link before a
+// single status is read back, so drivers with KHR_parallel_shader_compile (and
+// drivers that compile on their own worker threads anyway) spread the work over
+// all cores instead of finishing one program before starting the next.
+//
+//   ShaderBatch batch;
+//   batch.add(a, "a.vs", "a.fs");
+//   batch.add(b, "b.vs", "b.fs");
+//   batch.submit();
+//   while (!batch.poll())
+//       ... draw a loading frame ...
+class ShaderBatch
+{
+public:
+    // shader must stay alive until the batch is done with it
+    // ------------------------------------------------------------------------
+    void add(Shader& shader, const char* vertexPath, const char* fragmentPath, ProgramBinaryCache* cache = NULL)
+    {
+        Job job;
+        job.shader = &shader;
+        job.cache = cache;
+        job.name = std::string(vertexPath) + " / " + fragmentPath;
+        if (!job.vertexFile.open(vertexPath) || !job.fragmentFile.open(fragmentPath))
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << job.name << std::endl;
+            job.state = FAILED;
+        }
+        jobs.push_back(std::move(job));
+    }
+    // ------------------------------------------------------------------------
+    void submit()
+    {
+        // 0xFFFFFFFF lets the implementation pick the thread count
+        if (glext().parallelShaderCompile)
+            glext().MaxShaderCompilerThreads(0xFFFFFFFF);
+        for (Job& job : jobs)
+        {
+            if (job.state != QUEUED)
+                continue;
+            job.shader->beginBuild(ShaderSource(job.vertexFile.data(), job.vertexFile.size()),
+                                   ShaderSource(job.fragmentFile.data(), job.fragmentFile.size()), job.cache);
+            job.state = COMPILING;
+            // glShaderSource copied the text, the mappings are not needed any more
+            job.vertexFile.close();
+            job.fragmentFile.close();
+        }
+    }
+    // finish every program whose link is done. never blocks when the driver
+    // supports parallel compile, without it the first call finishes everything.
+    // returns true once all submitted shaders are built.
+    // ------------------------------------------------------------------------
+    bool poll()
+    {
+        bool done = true;
+        for (Job& job : jobs)
+        {
+            if (job.state != COMPILING)
+                continue;
+            if (!job.shader->buildComplete())
+            {
+                done = false;
+                continue;
+            }
+            job.state = job.shader->endBuild() ? BUILT : FAILED;
+            if (job.state == FAILED)
+                std::cout << "ERROR::SHADER::BATCH_BUILD_FAILED " << job.name << std::endl;
+        }
+        return done;
+    }
+    // block until everything submitted is built
+    // ------------------------------------------------------------------------
+    void finish()
+    {
+        for (Job& job : jobs)
+        {
+            if (job.state == COMPILING)
+            {
+                job.state = job.shader->endBuild() ? BUILT : FAILED;
+                if (job.state == FAILED)
+                    std::cout << "ERROR::SHADER::BATCH_BUILD_FAILED " << job.name << std::endl;
+            }
+        }
+    }
+    // ------------------------------------------------------------------------
+    unsigned int failed() const
+    {
+        unsigned int count = 0;
+        for (const Job& job : jobs)
+            count += job.state == FAILED;
+        return count;
+    }
+
+private:
+    enum State
+    {
+        QUEUED,
+        COMPILING,
+        BUILT,
+        FAILED
+    };
+    struct Job
+    {
+        Shader* shader;
+        ProgramBinaryCache* cache;
+        std::string name;
+        MappedFile vertexFile;
+        MappedFile fragmentFile;
+        State state = QUEUED;
+    };
+    std::vector<Job> jobs;
+};
+
+#endif /* ShaderBatch_h */
@@ -0,0 +1,52 @@
+//
+//  ShaderSource.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef ShaderSource_h
+#define ShaderSource_h
+
+#include <cstddef>
+#include <string>
+
+// non-owning view of shader text with an explicit length, handed to
+// glShaderSource as is. points into a MappedFile, a std::string, or a string
+// literal compiled into the binary:
+//
+//   constexpr ShaderSource vertexSource = "#version 330 core\n ...";
+struct ShaderSource
+{
+    const char* data;
+    int length;
+
+    constexpr ShaderSource()
+        : data(""), length(0)
+    {
+    }
+    constexpr ShaderSource(const char* text, size_t size)
+        : data(text), length((int)size)
+    {
+    }
+    ShaderSource(const std::string& text)
+        : data(text.data()), length((int)text.size())
+    {
+    }
+    // literals, trailing NULs (the old "...}\0" style) are not part of the text
+    template <size_t N>
+    constexpr ShaderSource(const char (&text)[N])
+        : data(text), length(literalLength(text, N))
+    {
+    }
+
+private:
+    static constexpr int literalLength(const char* text, size_t size)
+    {
+        while (size > 0 && text[size - 1] == '\0')
+            size--;
+        return (int)size;
+    }
+};
+
+#endif /* ShaderSource_h */
@@ -0,0 +1,287 @@
+//
+//  ShaderVariants.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef ShaderVariants_h
+#define ShaderVariants_h
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <iostream>
+
+#include "GLExtensions.h"
+#include "Shader.h"
+#include "Hash.h"
+
+// expands #include "file" (relative to the including file, each file at most
+// once) and injects a set of #defines right after the #version line.
+class ShaderPreprocessor
+{
+public:
+    // ------------------------------------------------------------------------
+    static bool expand(const std::string& path, std::string& out)
+    {
+        std::vector<std::string> included;
+        out.clear();
+        return expandFile(path, out, included);
+    }
+    // define is "NAME" or "NAME=VALUE". defines whose name never appears in
+    // source are dropped, they cannot change the program and would only
+    // produce a duplicate permutation.
+    // ------------------------------------------------------------------------
+    static std::string inject(const std::string& source, std::vector<std::string> defines)
+    {
+        std::sort(defines.begin(), defines.end());
+        defines.erase(std::unique(defines.begin(), defines.end()), defines.end());
+
+        std::string block;
+        for (const std::string& define : defines)
+        {
+            size_t equals = define.find('=');
+            std::string name = define.substr(0, equals);
+            if (!containsToken(source, name))
+                continue;
+            block += "#define " + name;
+            if (equals != std::string::npos)
+                block += " " + define.substr(equals + 1);
+            block += "\n";
+        }
+        if (block.empty())
+            return source;
+
+        // #version has to stay the first statement
+        size_t insertAt = 0;
+        size_t version = source.find("#version");
+        if (version != std::string::npos)
+        {
+            size_t lineEnd = source.find('\n', version);
+            insertAt = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+        }
+        return source.substr(0, insertAt) + block + source.substr(insertAt);
+    }
+
+private:
+    // ------------------------------------------------------------------------
+    static bool expandFile(const std::string& path, std::string& out, std::vector<std::string>& included)
+    {
+        if (std::find(included.begin(), included.end(), path) != included.end())
+            return true;
+        included.push_back(path);
+
+        std::string source;
+        if (!Shader::readFile(path.c_str(), source))
+        {
+            std::cout << "ERROR::SHADER::INCLUDE_NOT_FOUND " << path << std::endl;
+            return false;
+        }
+
+        size_t slash = path.find_last_of('/');
+        std::string directory = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+        size_t pos = 0;
+        while (pos < source.size())
+        {
+            size_t lineEnd = source.find('\n', pos);
+            if (lineEnd == std::string::npos)
+                lineEnd = source.size();
+            std::string line = source.substr(pos, lineEnd - pos);
+            pos = lineEnd + 1;
+
+            size_t first = line.find_first_not_of(" \t");
+            if (first != std::string::npos && line.compare(first, 8, "#include") == 0)
+            {
+                size_t open = line.find('"', first);
+                size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+                if (close == std::string::npos)
+                {
+                    std::cout << "ERROR::SHADER::BAD_INCLUDE " << path << ": " << line << std::endl;
+                    return false;
+                }
+                if (!expandFile(directory + line.substr(open + 1, close - open - 1), out, included))
+                    return false;
+                continue;
+            }
+            out += line;
+            out += '\n';
+        }
+        return true;
+    }
+    // whole identifier match, so FOG does not match FOG_DENSITY
+    // ------------------------------------------------------------------------
+    static bool containsToken(const std::string& source, const std::string& name)
+    {
+        for (size_t pos = source.find(name); pos != std::string::npos; pos = source.find(name, pos + 1))
+        {
+            bool startOk = pos == 0 || !isIdentifier(source[pos - 1]);
+            size_t end = pos + name.size();
+            bool endOk = end >= source.size() || !isIdentifier(source[end]);
+            if (startOk && endOk)
+                return true;
+        }
+        return false;
+    }
+    static bool isIdentifier(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+};
+
+// compiles shader permutations on demand. a request is first looked up by
+// files + define set, then by the hash of the preprocessed sources, so two
+// define sets that expand to the same text share one program. nothing is
+// compiled until a variant is actually asked for. a variant that fails to
+// preprocess, compile or link is reported, comes back with ID 0 and is not
+// cached, so asking again after fixing the file builds it.
+//
+//   ShaderVariants variants;
+//   Shader& lit = variants.get("mesh.vs", "mesh.fs", { "USE_TEXTURE", "LIGHTS=4" });
+//
+// request() only issues the compile and link, like ShaderBatch::submit, so
+// several variants requested before one finish() compile in parallel:
+//
+//   Shader& a = variants.request("a.vs", "a.fs");
+//   Shader& b = variants.request("a.vs", "a.fs", { "SKINNED" });
+//   variants.finish();  // a and b are usable from here on
+class ShaderVariants
+{
+public:
+    struct Stats
+    {
+        unsigned int requests = 0;
+        unsigned int compiled = 0;
+        unsigned int deduplicated = 0;  // new define set, already built sources
+        unsigned int failed = 0;
+    };
+
+    ShaderVariants(ProgramBinaryCache* cache = NULL)
+        : cache(cache)
+    {
+    }
+    // built variant, finishes everything requested before it as well.
+    // returned reference stays valid for the lifetime of this object
+    // ------------------------------------------------------------------------
+    Shader& get(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines = std::vector<std::string>())
+    {
+        Shader& shader = request(vertexPath, fragmentPath, defines);
+        finish();
+        return shader;
+    }
+    // starts the build and returns without waiting for it. the shader must
+    // not be used before finish(), after that it is built or has ID 0
+    // ------------------------------------------------------------------------
+    Shader& request(const char* vertexPath, const char* fragmentPath, const std::vector<std::string>& defines = std::vector<std::string>())
+    {
+        stat.requests++;
+        std::vector<std::string> sorted(defines);
+        std::sort(sorted.begin(), sorted.end());
+        std::string request = std::string(vertexPath) + "|" + fragmentPath;
+        for (const std::string& define : sorted)
+            request += "|" + define;
+        unsigned long long requestKey = fnv1a(request.data(), request.size());
+        auto known = requests.find(requestKey);
+        if (known != requests.end())
+            return *known->second;
+
+        std::string vertexCode, fragmentCode;
+        if (!ShaderPreprocessor::expand(vertexPath, vertexCode) || !ShaderPreprocessor::expand(fragmentPath, fragmentCode))
+        {
+            return failure(request);
+        }
+        vertexCode = ShaderPreprocessor::inject(vertexCode, sorted);
+        fragmentCode = ShaderPreprocessor::inject(fragmentCode, sorted);
+
+        unsigned long long sourceKey = fnv1a(vertexCode.data(), vertexCode.size());
+        sourceKey = fnv1a("\0", 1, sourceKey);
+        sourceKey = fnv1a(fragmentCode.data(), fragmentCode.size(), sourceKey);
+        auto built = programs.find(sourceKey);
+        if (built != programs.end())
+        {
+            stat.deduplicated++;
+            requests[requestKey] = built->second.get();
+            return *built->second;
+        }
+
+        // 0xFFFFFFFF lets the implementation pick the thread count
+        if (pending.empty() && glext().parallelShaderCompile)
+            glext().MaxShaderCompilerThreads(0xFFFFFFFF);
+        std::unique_ptr<Shader> program(new Shader());
+        program->beginBuild(vertexCode, fragmentCode, cache);
+        Shader& shader = *program;
+        programs[sourceKey] = std::move(program);
+        requests[requestKey] = &shader;
+        pending.push_back({ request, sourceKey });
+        return shader;
+    }
+    // reads back every build request() started, false if any failed. failed
+    // variants keep their object, with ID 0, but leave the caches
+    // ------------------------------------------------------------------------
+    bool finish()
+    {
+        bool ok = true;
+        for (const Pending& build : pending)
+        {
+            std::unique_ptr<Shader>& program = programs[build.sourceKey];
+            if (program->endBuild())
+            {
+                stat.compiled++;
+                continue;
+            }
+            glDeleteProgram(program->ID);
+            program->ID = 0;
+            report(build.request);
+            failures.push_back(std::move(program));
+            programs.erase(build.sourceKey);
+            // every request deduplicated onto it has to go too
+            for (auto i = requests.begin(); i != requests.end();)
+            {
+                if (i->second == failures.back().get())
+                    i = requests.erase(i);
+                else
+                    ++i;
+            }
+            ok = false;
+        }
+        pending.clear();
+        return ok;
+    }
+    // ------------------------------------------------------------------------
+    const Stats& stats() const
+    {
+        return stat;
+    }
+
+private:
+    struct Pending
+    {
+        std::string request;
+        unsigned long long sourceKey;
+    };
+
+    ProgramBinaryCache* cache;
+    std::vector<std::unique_ptr<Shader> > failures;  // one ID 0 shader per failed request, never looked up
+    std::map<unsigned long long, std::unique_ptr<Shader> > programs;
+    std::map<unsigned long long, Shader*> requests;
+    std::vector<Pending> pending;       // between request() and finish()
+    Stats stat;
+
+    // its own object, so a watcher reloading one never touches another
+    // ------------------------------------------------------------------------
+    Shader& failure(const std::string& request)
+    {
+        report(request);
+        failures.push_back(std::unique_ptr<Shader>(new Shader()));
+        return *failures.back();
+    }
+    void report(const std::string& request)
+    {
+        std::cout << "ERROR::SHADER::VARIANT_FAILED " << request << std::endl;
+        stat.failed++;
+    }
+};
+
+#endif /* ShaderVariants_h */
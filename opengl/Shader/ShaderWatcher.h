@@ -0,0 +1,215 @@
+//
+//  ShaderWatcher.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef ShaderWatcher_h
+#define ShaderWatcher_h
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "Shader.h"
+#include "ShaderVariants.h"
+
+// hot reload for shader sources. a background thread notices edits (inotify on
+// linux, mtime polling elsewhere) and reads the new text off the render thread.
+// poll() is called once per frame on the GL thread, it rebuilds the changed
+// programs and swaps them in at that frame boundary. a program that fails to
+// compile is reported and the old one keeps drawing. #include is expanded on
+// reload, but only the two watched files trigger one.
+class ShaderWatcher
+{
+public:
+    ShaderWatcher()
+        : running(true)
+    {
+#ifdef __linux__
+        notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+        worker = std::thread(&ShaderWatcher::run, this);
+    }
+    ~ShaderWatcher()
+    {
+        running = false;
+        worker.join();
+#ifdef __linux__
+        if (notifyFd >= 0)
+            close(notifyFd);
+#endif
+    }
+    // shader must outlive the watcher
+    // ------------------------------------------------------------------------
+    void watch(Shader& shader, const char* vertexPath, const char* fragmentPath)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry entry;
+        entry.shader = &shader;
+        entry.paths[0] = vertexPath;
+        entry.paths[1] = fragmentPath;
+        for (int i = 0; i < 2; i++)
+        {
+            entry.modified[i] = modifiedTime(entry.paths[i]);
+#ifdef __linux__
+            // watch the directory, editors usually save by renaming over the file
+            entry.watches[i] = notifyFd >= 0 ? inotify_add_watch(notifyFd, directoryOf(entry.paths[i]).c_str(),
+                IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) : -1;
+#endif
+        }
+        entries.push_back(entry);
+    }
+    // swap in every program whose sources changed. returns how many were swapped
+    // ------------------------------------------------------------------------
+    int poll()
+    {
+        std::vector<Pending> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.swap(pending);
+        }
+        int swapped = 0;
+        for (const Pending& p : ready)
+        {
+            if (p.shader->reload(p.vertexCode, p.fragmentCode))
+            {
+                std::cout << "SHADER::RELOADED " << p.name << std::endl;
+                swapped++;
+            }
+            else
+            {
+                std::cout << "SHADER::RELOAD_FAILED " << p.name << ", keeping the previous program" << std::endl;
+            }
+        }
+        return swapped;
+    }
+
+private:
+    struct Entry
+    {
+        Shader* shader;
+        std::string paths[2];
+        long long modified[2];
+        int watches[2] = { -1, -1 };
+        bool dirty = false;
+    };
+    struct Pending
+    {
+        Shader* shader;
+        std::string name;
+        std::string vertexCode;
+        std::string fragmentCode;
+    };
+
+    std::thread worker;
+    std::atomic<bool> running;
+    std::mutex mutex;
+    std::vector<Entry> entries;
+    std::vector<Pending> pending;
+    int notifyFd = -1;
+
+    // ------------------------------------------------------------------------
+    void run()
+    {
+        while (running)
+        {
+            if (!waitForChanges())
+                continue;
+            // let the editor finish writing before the sources are read
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (Entry& entry : entries)
+            {
+                for (int i = 0; i < 2; i++)
+                {
+                    long long modified = modifiedTime(entry.paths[i]);
+                    if (modified != entry.modified[i])
+                    {
+                        entry.modified[i] = modified;
+                        entry.dirty = true;
+                    }
+                }
+                if (!entry.dirty)
+                    continue;
+                Pending p;
+                p.shader = entry.shader;
+                p.name = entry.paths[0] + " / " + entry.paths[1];
+                if (ShaderPreprocessor::expand(entry.paths[0], p.vertexCode)
+                    && ShaderPreprocessor::expand(entry.paths[1], p.fragmentCode))
+                {
+                    // a newer edit replaces a reload that was not picked up yet
+                    removePending(entry.shader);
+                    pending.push_back(p);
+                    entry.dirty = false;
+                }
+            }
+        }
+    }
+    // block for a while, true if something might have changed
+    // ------------------------------------------------------------------------
+    bool waitForChanges()
+    {
+#ifdef __linux__
+        if (notifyFd >= 0)
+        {
+            pollfd fd = { notifyFd, POLLIN, 0 };
+            if (::poll(&fd, 1, 200) <= 0)
+                return false;
+            // drain the queue, the entries compare mtimes to see what changed
+            char buffer[4096];
+            while (read(notifyFd, buffer, sizeof(buffer)) > 0)
+            {
+            }
+            return true;
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void removePending(Shader* shader)
+    {
+        for (size_t i = 0; i < pending.size(); i++)
+        {
+            if (pending[i].shader == shader)
+            {
+                pending.erase(pending.begin() + i);
+                return;
+            }
+        }
+    }
+    // ------------------------------------------------------------------------
+    static long long modifiedTime(const std::string& path)
+    {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+            return -1;
+#ifdef __APPLE__
+        return (long long)info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+        return (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+    }
+    // ------------------------------------------------------------------------
+    static std::string directoryOf(const std::string& path)
+    {
+        size_t slash = path.find_last_of('/');
+        return slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    }
+};
+
+#endif /* ShaderWatcher_h */
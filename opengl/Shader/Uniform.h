@@ -0,0 +1,174 @@
+//
+//  Uniform.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef Uniform_h
+#define Uniform_h
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+
+#include "Shader.h"
+#include "Hash.h"
+
+// uniform name hashed with FNV-1a at compile time when declared constexpr:
+//
+//   constexpr UniformName MODEL = "model";
+struct UniformName
+{
+    const char* name;
+    unsigned long long hash;
+
+    template <size_t N>
+    constexpr UniformName(const char (&text)[N])
+        : name(text), hash(fnv1a(text, N - 1))
+    {
+    }
+};
+
+// GLSL type each C++ type may bind to, and the matching glUniform* call
+template <typename T> struct UniformTraits;
+
+template <> struct UniformTraits<float>
+{
+    typedef float Stored;
+    static const char* glsl() { return "float"; }
+    static bool accepts(GLenum type) { return type == GL_FLOAT; }
+    static Stored store(float value) { return value; }
+    static void upload(int location, const Stored& value) { glUniform1f(location, value); }
+};
+
+template <> struct UniformTraits<int>
+{
+    typedef int Stored;
+    static const char* glsl() { return "int/sampler"; }
+    static bool accepts(GLenum type)
+    {
+        switch (type)
+        {
+            case GL_INT:
+            case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+            case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_BUFFER:
+            case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D:
+                return true;
+            default:
+                return false;
+        }
+    }
+    static Stored store(int value) { return value; }
+    static void upload(int location, const Stored& value) { glUniform1i(location, value); }
+};
+
+template <> struct UniformTraits<bool>
+{
+    // stored as int, the same bits Shader::setBool shadows
+    typedef int Stored;
+    static const char* glsl() { return "bool"; }
+    static bool accepts(GLenum type) { return type == GL_BOOL; }
+    static Stored store(bool value) { return (int)value; }
+    static void upload(int location, const Stored& value) { glUniform1i(location, value); }
+};
+
+template <> struct UniformTraits<glm::vec2>
+{
+    typedef glm::vec2 Stored;
+    static const char* glsl() { return "vec2"; }
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC2; }
+    static Stored store(const glm::vec2& value) { return value; }
+    static void upload(int location, const Stored& value) { glUniform2fv(location, 1, glm::value_ptr(value)); }
+};
+
+template <> struct UniformTraits<glm::vec3>
+{
+    typedef glm::vec3 Stored;
+    static const char* glsl() { return "vec3"; }
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC3; }
+    static Stored store(const glm::vec3& value) { return value; }
+    static void upload(int location, const Stored& value) { glUniform3fv(location, 1, glm::value_ptr(value)); }
+};
+
+template <> struct UniformTraits<glm::vec4>
+{
+    typedef glm::vec4 Stored;
+    static const char* glsl() { return "vec4"; }
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC4; }
+    static Stored store(const glm::vec4& value) { return value; }
+    static void upload(int location, const Stored& value) { glUniform4fv(location, 1, glm::value_ptr(value)); }
+};
+
+template <> struct UniformTraits<glm::mat4>
+{
+    typedef glm::mat4 Stored;
+    static const char* glsl() { return "mat4"; }
+    static bool accepts(GLenum type) { return type == GL_FLOAT_MAT4; }
+    static const Stored& store(const glm::mat4& value) { return value; }
+    static void upload(int location, const Stored& value) { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+};
+
+// typed handle to one uniform of one Shader. the name is looked up and the
+// C++ type checked against the reflected GLSL type once, when the handle is
+// created. a mismatch is reported there and leaves the handle invalid, so
+// setting it is a no-op. set() is a shadow compare plus the glUniform* call.
+//
+//   constexpr UniformName MODEL = "model";
+//   Uniform<glm::mat4> model(ourShader, MODEL);
+//   ...
+//   model = glm::rotate(...);
+template <typename T>
+class Uniform
+{
+public:
+    Uniform()
+        : shader(NULL)
+    {
+    }
+    Uniform(const Shader& shader, UniformName name)
+        : shader(&shader)
+    {
+        static_assert(sizeof(typename UniformTraits<T>::Stored) <= 16 * sizeof(float), "uniform larger than the shadow slot");
+        UniformHandle found = shader.findUniform(name.hash);
+        if (!found.valid())
+            return;
+        GLenum type = shader.uniformType(found);
+        if (!UniformTraits<T>::accepts(type))
+        {
+            std::cout << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH " << name.name << ": declared as GL type 0x"
+                      << std::hex << type << std::dec << ", set as " << UniformTraits<T>::glsl() << std::endl;
+            return;
+        }
+        handle = found;
+    }
+    // ------------------------------------------------------------------------
+    bool valid() const
+    {
+        return handle.valid();
+    }
+    // ------------------------------------------------------------------------
+    void set(const T& value) const
+    {
+        if (!handle.valid())
+            return;
+        const typename UniformTraits<T>::Stored& stored = UniformTraits<T>::store(value);
+        if (shader->shadow(handle, &stored, sizeof(stored)))
+            UniformTraits<T>::upload(shader->location(handle), stored);
+    }
+    // ------------------------------------------------------------------------
+    Uniform& operator=(const T& value)
+    {
+        set(value);
+        return *this;
+    }
+
+private:
+    const Shader* shader;
+    UniformHandle handle;
+};
+
+#endif /* Uniform_h */
@@ -9,6 +9,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "Shader.h"
+#include "VertexLayout.h"
 
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
@@ -65,25 +66,24 @@ int triangle2()
     unsigned int VAO;
     glGenVertexArrays(1, &VAO);
     
-    glBindVertexArray(VAO);
+    glstate().bindVertexArray(VAO);
     
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     
     // read vertex
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    constexpr VertexLayout layout = { { 0, VertexFormat::FLOAT3 }, { 1, VertexFormat::FLOAT3 } };
+    layout.apply();
     
     // unbind VBO
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     
     // unbind VAO
-    glBindVertexArray(0);
+    glstate().bindVertexArray(0);
 
     // shader
     Shader ourShader("shader1.vs", "shader1.fs");
+    UniformHandle vertexColorLocation = ourShader.uniform("timeColor");
     
     // render loop
     // -----------
@@ -101,13 +101,12 @@ int triangle2()
         float timeValue = glfwGetTime();
         float color1 = (sin(timeValue) / 2.0f) + 0.5f;
         float color2 = (cos(timeValue) / 2.0f) + 0.5f;
-        int vertexColorLocation = glGetUniformLocation(ourShader.ID, "timeColor");
         // program
         ourShader.use();
         
-        glUniform4f(vertexColorLocation, color1, color2, color1, color2);
+        ourShader.setVec4(vertexColorLocation, color1, color2, color1, color2);
         
-        glBindVertexArray(VAO);
+        glstate().bindVertexArray(VAO);
         // draw
         glDrawArrays(GL_TRIANGLES, 0, 3);
         
@@ -9,6 +9,8 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include "Shader.h"
+#include "Uniform.h"
+#include "VertexLayout.h"
 
 #include "stb_image.h"
 
@@ -17,6 +19,11 @@ const unsigned int SCR_HEIGHT = 600;
 
 float visible = 0.5;
 
+// uniform names, hashed at compile time
+constexpr UniformName OUR_TEXTURE_1 = "ourTexture";
+constexpr UniformName OUR_TEXTURE_2 = "ourTexture2";
+constexpr UniformName VISIBLE = "visible";
+
 void framebuffer_size_callback3(GLFWwindow* window, int width, int height);
 
 void processInput3(GLFWwindow *window)
@@ -74,8 +81,7 @@ int draw_texture_main()
     unsigned int texture1;
     glGenTextures(1, &texture1);
     
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture1);
+    glstate().bindTexture(0, GL_TEXTURE_2D, texture1);
     
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data1);
     glGenerateMipmap(GL_TEXTURE_2D);
@@ -89,8 +95,7 @@ int draw_texture_main()
     // texture
     unsigned int texture2;
     glGenTextures(1, &texture2);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, texture2);
+    glstate().bindTexture(1, GL_TEXTURE_2D, texture2);
     
     // 为当前绑定的纹理对象设置环绕、过滤方式
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -136,7 +141,7 @@ int draw_texture_main()
     unsigned int EBO;
     glGenBuffers(1, &EBO);
     
-    glBindVertexArray(VAO);
+    glstate().bindVertexArray(VAO);
     
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -145,26 +150,22 @@ int draw_texture_main()
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
     
     // read vertex
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    constexpr VertexLayout layout = { { 0, VertexFormat::FLOAT3 }, { 1, VertexFormat::FLOAT3 }, { 2, VertexFormat::FLOAT2 } };
+    layout.apply();
     
     // unbind VBO
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     
     // unbind VAO
-    glBindVertexArray(0);
+    glstate().bindVertexArray(0);
 
     // shader
     Shader ourShader("shader2.vs", "shader2.fs");
     ourShader.use();
     
-    glUniform1i(glGetUniformLocation(ourShader.ID, "ourTexture"), 0); // 手动设置
-    glUniform1i(glGetUniformLocation(ourShader.ID, "ourTexture2"), 1);
-//    ourShader.setInt("ourTexture2", 1); // 或者使用着色器类设置
+    Uniform<int>(ourShader, OUR_TEXTURE_1) = 0;
+    Uniform<int>(ourShader, OUR_TEXTURE_2) = 1;
+    Uniform<glm::vec2> visibleUniform(ourShader, VISIBLE);
     
     // render loop
     // -----------
@@ -180,8 +181,8 @@ int draw_texture_main()
         glClear(GL_COLOR_BUFFER_BIT);
 
         // program
-        glUniform2f(glGetUniformLocation(ourShader.ID, "visible"), visible, 0);
-        glBindVertexArray(VAO);
+        visibleUniform = glm::vec2(visible, 0);
+        glstate().bindVertexArray(VAO);
         // draw
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
         
@@ -0,0 +1,230 @@
+//
+//  meshconv.cpp
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+//  offline converter from Wavefront .obj to the MeshFile format, not part of
+//  the app target. build it on its own, e.g.
+//
+//    c++ -std=gnu++14 -O2 -I../includes -I../Mesh -I../Render -I../Shader meshconv.cpp ../includes/glad.c -o meshconv
+//
+//  usage: meshconv input.obj output.mesh [--float]
+//         meshconv --bench input.obj output.mesh
+//
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+
+#include "MeshOptimizer.h"
+#include "MeshFile.h"
+#include "VertexLayout.h"
+
+// triangle soup as parsed: position, normal, uv
+constexpr VertexLayout OBJ_LAYOUT = { { 0, VertexFormat::FLOAT3 }, { 1, VertexFormat::FLOAT3 }, { 2, VertexFormat::FLOAT2 } };
+// what goes to disk by default, 32 -> 16 bytes per vertex. uvs stay half
+// floats instead of unorm since obj files often tile past 0..1
+constexpr VertexLayout PACKED_LAYOUT = { { 0, VertexFormat::HALF4 }, { 1, VertexFormat::SNORM_2_10_10_10 }, { 2, VertexFormat::HALF2 } };
+
+static double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// obj indices are 1-based, negative ones count back from the end
+static int resolveIndex(const char* token, size_t count)
+{
+    int index = atoi(token);
+    return index < 0 ? (int)count + index : index - 1;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+static bool parseObj(const char* path, std::vector<float>& soup)
+{
+    FILE* file = fopen(path, "r");
+    if (!file)
+    {
+        std::cout << "ERROR::MESHCONV::FILE_NOT_SUCCESFULLY_READ " << path << std::endl;
+        return false;
+    }
+
+    std::vector<float> positions, normals, uvs;
+    std::vector<int> corners;  // position, uv, normal triples of the current face
+    char line[1024];
+    while (fgets(line, sizeof(line), file))
+    {
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+        if (strncmp(line, "v ", 2) == 0 && sscanf(line + 2, "%f %f %f", &x, &y, &z) == 3)
+        {
+            positions.insert(positions.end(), { x, y, z });
+        }
+        else if (strncmp(line, "vn ", 3) == 0 && sscanf(line + 3, "%f %f %f", &x, &y, &z) == 3)
+        {
+            normals.insert(normals.end(), { x, y, z });
+        }
+        else if (strncmp(line, "vt ", 3) == 0 && sscanf(line + 3, "%f %f", &x, &y) == 2)
+        {
+            uvs.insert(uvs.end(), { x, y });
+        }
+        else if (strncmp(line, "f ", 2) == 0)
+        {
+            corners.clear();
+            for (char* token = strtok(line + 2, " \t\r\n"); token; token = strtok(NULL, " \t\r\n"))
+            {
+                // v, v/vt, v//vn or v/vt/vn
+                char* slash = strchr(token, '/');
+                int position = resolveIndex(token, positions.size() / 3);
+                int uv = -1, normal = -1;
+                if (slash)
+                {
+                    if (slash[1] != '/')
+                        uv = resolveIndex(slash + 1, uvs.size() / 2);
+                    char* second = strchr(slash + 1, '/');
+                    if (second)
+                        normal = resolveIndex(second + 1, normals.size() / 3);
+                }
+                if (position < 0 || (size_t)position >= positions.size() / 3)
+                    continue;
+                corners.insert(corners.end(), { position, uv, normal });
+            }
+
+            // fan triangulation, fine for the convex polygons exporters write
+            for (size_t c = 2; c < corners.size() / 3; c++)
+            {
+                const size_t triangle[3] = { 0, c - 1, c };
+                const float* p[3];
+                for (int k = 0; k < 3; k++)
+                    p[k] = &positions[corners[triangle[k] * 3] * 3];
+                // face normal for corners that come without one
+                float e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+                float e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+                float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+                float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (int k = 0; k < 3 && length > 0.0f; k++)
+                    n[k] /= length;
+
+                for (int k = 0; k < 3; k++)
+                {
+                    const int* corner = &corners[triangle[k] * 3];
+                    soup.insert(soup.end(), p[k], p[k] + 3);
+                    if (corner[2] >= 0 && (size_t)corner[2] < normals.size() / 3)
+                        soup.insert(soup.end(), &normals[corner[2] * 3], &normals[corner[2] * 3] + 3);
+                    else
+                        soup.insert(soup.end(), n, n + 3);
+                    if (corner[1] >= 0 && (size_t)corner[1] < uvs.size() / 2)
+                        soup.insert(soup.end(), &uvs[corner[1] * 2], &uvs[corner[1] * 2] + 2);
+                    else
+                        soup.insert(soup.end(), { 0.0f, 0.0f });
+                }
+            }
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------
+static bool convert(const char* input, const char* output, bool packed, bool verbose)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<float> soup;
+    if (!parseObj(input, soup))
+        return false;
+    double parseMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    MeshOptimizer::Report report;
+    IndexedMesh mesh = MeshOptimizer::optimize(soup.data(), soup.size() / (OBJ_LAYOUT.stride() / sizeof(float)),
+                                               OBJ_LAYOUT.stride() / sizeof(float), &report);
+
+    float boundsMin[3] = { HUGE_VALF, HUGE_VALF, HUGE_VALF };
+    float boundsMax[3] = { -HUGE_VALF, -HUGE_VALF, -HUGE_VALF };
+    for (size_t v = 0; v < mesh.vertexCount(); v++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            float value = mesh.vertices[v * mesh.stride + k];
+            boundsMin[k] = value < boundsMin[k] ? value : boundsMin[k];
+            boundsMax[k] = value > boundsMax[k] ? value : boundsMax[k];
+        }
+    }
+
+    const VertexLayout& layout = packed ? PACKED_LAYOUT : OBJ_LAYOUT;
+    std::vector<unsigned char> vertices;
+    layout.pack(mesh.vertices.data(), mesh.vertexCount(), OBJ_LAYOUT, vertices);
+    double optimizeMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    if (!MeshFile::write(output, layout, vertices.data(), mesh.vertexCount(), mesh.indexType(), mesh.indexData(),
+                         mesh.indices.size(), boundsMin, boundsMax))
+        return false;
+    double writeMs = elapsedMs(start);
+
+    std::cout << output << ": " << mesh.vertexCount() << " vertices (" << report.inputVertices << " before weld), "
+              << report.triangles << " triangles, " << layout.stride() << " bytes per vertex, "
+              << (mesh.indexType() == GL_UNSIGNED_SHORT ? 16 : 32) << "-bit indices, ACMR "
+              << report.acmrBefore << " -> " << report.acmrAfter << std::endl;
+    if (verbose)
+        std::cout << "MESHCONV parse=" << parseMs << "ms optimize+pack=" << optimizeMs << "ms write=" << writeMs << "ms" << std::endl;
+    return true;
+}
+
+// what a startup load costs: map + validate, then one pass over the blobs the
+// way glBufferData reads them. compared with parsing the obj again.
+// ---------------------------------------------------------------------------------------------------------
+static bool benchmark(const char* input, const char* output)
+{
+    if (!convert(input, output, true, true))
+        return false;
+
+    const int RUNS = 10;
+    double openMs = 0.0, readMs = 0.0;
+    unsigned long long checksum = 0;
+    for (int run = 0; run < RUNS; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        MeshFile mesh;
+        if (!mesh.open(output))
+            return false;
+        openMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        const MeshFileHeader& h = mesh.header();
+        const unsigned char* vertices = (const unsigned char*)mesh.vertexData();
+        const unsigned char* indices = (const unsigned char*)mesh.indexData();
+        for (unsigned long long i = 0; i < h.vertexBytes; i += 64)
+            checksum += vertices[i];
+        for (unsigned long long i = 0; i < h.indexBytes; i += 64)
+            checksum += indices[i];
+        readMs += elapsedMs(start);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<float> soup;
+    parseObj(input, soup);
+    double parseMs = elapsedMs(start);
+
+    std::cout << "BENCHMARK mesh open=" << openMs / RUNS << "ms touch=" << readMs / RUNS
+              << "ms (warm page cache), obj parse=" << parseMs << "ms, checksum " << checksum << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 4 && strcmp(argv[1], "--bench") == 0)
+        return benchmark(argv[2], argv[3]) ? 0 : 1;
+    if (argc == 3 || (argc == 4 && strcmp(argv[3], "--float") == 0))
+        return convert(argv[1], argv[2], argc == 3, false) ? 0 : 1;
+
+    std::cout << "usage: meshconv input.obj output.mesh [--float]" << std::endl
+              << "       meshconv --bench input.obj output.mesh" << std::endl;
+    return 1;
+}
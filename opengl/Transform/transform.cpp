@@ -12,6 +12,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Shader.h"
+#include "VertexLayout.h"
 #include "stb_image.h"
 
 const unsigned int SCR_WIDTH = 800;
@@ -66,8 +67,7 @@ int transform()
     unsigned int texture1;
     glGenTextures(1, &texture1);
     
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture1);
+    glstate().bindTexture(0, GL_TEXTURE_2D, texture1);
     
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data1);
     glGenerateMipmap(GL_TEXTURE_2D);
@@ -98,7 +98,7 @@ int transform()
     unsigned int EBO;
     glGenBuffers(1, &EBO);
     
-    glBindVertexArray(VAO);
+    glstate().bindVertexArray(VAO);
     
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -107,22 +107,21 @@ int transform()
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
     
     // read vertex
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    constexpr VertexLayout layout = { { 0, VertexFormat::FLOAT3 }, { 2, VertexFormat::FLOAT2 } };
+    layout.apply();
     
     // unbind VBO
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     
     // unbind VAO
-    glBindVertexArray(0);
+    glstate().bindVertexArray(0);
 
     // shader
     Shader ourShader("shader3.vs", "shader3.fs");
     ourShader.use();
     
-    glUniform1i(glGetUniformLocation(ourShader.ID, "ourTexture"), 0); // 手动设置
+    ourShader.setInt("ourTexture", 0);
+    UniformHandle transformLoc = ourShader.uniform("transform");
     
     // render loop
     // -----------
@@ -141,11 +140,10 @@ int transform()
         glm::mat4 trans = glm::mat4(1.0f);
         trans = glm::rotate(trans, glm::radians(90.0f), glm::vec3(0.0, 0.0, 1.0));
         trans = glm::translate(trans, glm::vec3(0.5f, 0.f, 0.0f));
-        unsigned int transformLoc = glGetUniformLocation(ourShader.ID, "transform");
-        glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(trans));
+        ourShader.setMat4(transformLoc, glm::value_ptr(trans));
 
         // program
-        glBindVertexArray(VAO);
+        glstate().bindVertexArray(VAO);
         // draw
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
         
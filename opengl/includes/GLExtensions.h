@@ -0,0 +1,179 @@
+//
+//  GLExtensions.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef GLExtensions_h
+#define GLExtensions_h
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+// glad was generated for plain gl=3.3 core, so anything newer is loaded here
+// by hand. every entry point stays NULL when the driver does not expose it and
+// the matching flag is false, callers are expected to fall back.
+
+// GL 4.1 / ARB_get_program_binary
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// KHR_parallel_shader_compile / ARB_parallel_shader_compile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// GL 4.1 / ARB_separate_shader_objects
+#ifndef GL_PROGRAM_SEPARABLE
+#define GL_PROGRAM_SEPARABLE 0x8258
+#endif
+#ifndef GL_VERTEX_SHADER_BIT
+#define GL_VERTEX_SHADER_BIT 0x00000001
+#endif
+#ifndef GL_FRAGMENT_SHADER_BIT
+#define GL_FRAGMENT_SHADER_BIT 0x00000002
+#endif
+
+// GL 4.3 / ARB_multi_draw_indirect
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+// GL 4.4 / ARB_buffer_storage
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+#ifndef GL_CLIENT_STORAGE_BIT
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+typedef void (APIENTRYP PFNEXTGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP PFNEXTPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRYP PFNEXTPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNEXTMAXSHADERCOMPILERTHREADSPROC)(GLuint count);
+typedef void (APIENTRYP PFNEXTGENPROGRAMPIPELINESPROC)(GLsizei n, GLuint *pipelines);
+typedef void (APIENTRYP PFNEXTDELETEPROGRAMPIPELINESPROC)(GLsizei n, const GLuint *pipelines);
+typedef void (APIENTRYP PFNEXTBINDPROGRAMPIPELINEPROC)(GLuint pipeline);
+typedef void (APIENTRYP PFNEXTUSEPROGRAMSTAGESPROC)(GLuint pipeline, GLbitfield stages, GLuint program);
+typedef void (APIENTRYP PFNEXTDRAWARRAYSINSTANCEDBASEINSTANCEPROC)(GLenum mode, GLint first, GLsizei count, GLsizei instancecount, GLuint baseinstance);
+typedef void (APIENTRYP PFNEXTDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC)(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount, GLint basevertex, GLuint baseinstance);
+typedef void (APIENTRYP PFNEXTMULTIDRAWARRAYSINDIRECTPROC)(GLenum mode, const void *indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNEXTMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNEXTBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+struct GLExtensions
+{
+    bool loaded = false;
+    int majorVersion = 0;
+    int minorVersion = 0;
+
+    bool programBinary = false;
+    PFNEXTGETPROGRAMBINARYPROC GetProgramBinary = NULL;
+    PFNEXTPROGRAMBINARYPROC ProgramBinary = NULL;
+    PFNEXTPROGRAMPARAMETERIPROC ProgramParameteri = NULL;
+
+    bool parallelShaderCompile = false;
+    PFNEXTMAXSHADERCOMPILERTHREADSPROC MaxShaderCompilerThreads = NULL;
+
+    bool separateShaderObjects = false;
+    PFNEXTGENPROGRAMPIPELINESPROC GenProgramPipelines = NULL;
+    PFNEXTDELETEPROGRAMPIPELINESPROC DeleteProgramPipelines = NULL;
+    PFNEXTBINDPROGRAMPIPELINEPROC BindProgramPipeline = NULL;
+    PFNEXTUSEPROGRAMSTAGESPROC UseProgramStages = NULL;
+
+    bool baseInstance = false;
+    PFNEXTDRAWARRAYSINSTANCEDBASEINSTANCEPROC DrawArraysInstancedBaseInstance = NULL;
+    PFNEXTDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC DrawElementsInstancedBaseVertexBaseInstance = NULL;
+
+    bool multiDrawIndirect = false;
+    PFNEXTMULTIDRAWARRAYSINDIRECTPROC MultiDrawArraysIndirect = NULL;
+    PFNEXTMULTIDRAWELEMENTSINDIRECTPROC MultiDrawElementsIndirect = NULL;
+
+    bool bufferStorage = false;
+    PFNEXTBUFFERSTORAGEPROC BufferStorage = NULL;
+
+    // call once after gladLoadGLLoader, with the same loader
+    // ------------------------------------------------------------------------
+    void load(GLADloadproc loader)
+    {
+        glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+        glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+        GetProgramBinary = (PFNEXTGETPROGRAMBINARYPROC)loader("glGetProgramBinary");
+        ProgramBinary = (PFNEXTPROGRAMBINARYPROC)loader("glProgramBinary");
+        ProgramParameteri = (PFNEXTPROGRAMPARAMETERIPROC)loader("glProgramParameteri");
+        programBinary = (version(4, 1) || hasExtension("GL_ARB_get_program_binary"))
+            && GetProgramBinary && ProgramBinary && ProgramParameteri;
+
+        // both extensions share the token and the entry point signature
+        if (hasExtension("GL_KHR_parallel_shader_compile"))
+            MaxShaderCompilerThreads = (PFNEXTMAXSHADERCOMPILERTHREADSPROC)loader("glMaxShaderCompilerThreadsKHR");
+        else if (hasExtension("GL_ARB_parallel_shader_compile"))
+            MaxShaderCompilerThreads = (PFNEXTMAXSHADERCOMPILERTHREADSPROC)loader("glMaxShaderCompilerThreadsARB");
+        parallelShaderCompile = MaxShaderCompilerThreads != NULL;
+
+        GenProgramPipelines = (PFNEXTGENPROGRAMPIPELINESPROC)loader("glGenProgramPipelines");
+        DeleteProgramPipelines = (PFNEXTDELETEPROGRAMPIPELINESPROC)loader("glDeleteProgramPipelines");
+        BindProgramPipeline = (PFNEXTBINDPROGRAMPIPELINEPROC)loader("glBindProgramPipeline");
+        UseProgramStages = (PFNEXTUSEPROGRAMSTAGESPROC)loader("glUseProgramStages");
+        separateShaderObjects = (version(4, 1) || hasExtension("GL_ARB_separate_shader_objects"))
+            && GenProgramPipelines && DeleteProgramPipelines && BindProgramPipeline && UseProgramStages && ProgramParameteri;
+
+        DrawArraysInstancedBaseInstance = (PFNEXTDRAWARRAYSINSTANCEDBASEINSTANCEPROC)loader("glDrawArraysInstancedBaseInstance");
+        DrawElementsInstancedBaseVertexBaseInstance = (PFNEXTDRAWELEMENTSINSTANCEDBASEVERTEXBASEINSTANCEPROC)loader("glDrawElementsInstancedBaseVertexBaseInstance");
+        baseInstance = (version(4, 2) || hasExtension("GL_ARB_base_instance"))
+            && DrawArraysInstancedBaseInstance && DrawElementsInstancedBaseVertexBaseInstance;
+
+        // indirect commands only honour baseInstance together with base_instance
+        MultiDrawArraysIndirect = (PFNEXTMULTIDRAWARRAYSINDIRECTPROC)loader("glMultiDrawArraysIndirect");
+        MultiDrawElementsIndirect = (PFNEXTMULTIDRAWELEMENTSINDIRECTPROC)loader("glMultiDrawElementsIndirect");
+        multiDrawIndirect = (version(4, 3) || hasExtension("GL_ARB_multi_draw_indirect"))
+            && MultiDrawArraysIndirect && MultiDrawElementsIndirect && baseInstance;
+
+        BufferStorage = (PFNEXTBUFFERSTORAGEPROC)loader("glBufferStorage");
+        bufferStorage = (version(4, 4) || hasExtension("GL_ARB_buffer_storage")) && BufferStorage;
+
+        loaded = true;
+    }
+    // ------------------------------------------------------------------------
+    bool version(int major, int minor) const
+    {
+        return majorVersion > major || (majorVersion == major && minorVersion >= minor);
+    }
+    // ------------------------------------------------------------------------
+    bool hasExtension(const char* name) const
+    {
+        int count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (int i = 0; i < count; i++)
+        {
+            const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (ext && strcmp(ext, name) == 0)
+                return true;
+        }
+        return false;
+    }
+};
+
+inline GLExtensions& glext()
+{
+    static GLExtensions extensions;
+    return extensions;
+}
+
+#endif /* GLExtensions_h */
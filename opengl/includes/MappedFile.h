@@ -0,0 +1,117 @@
+//
+//  MappedFile.h
+//  opengl
+//
+//  Created by yangying on 2026/10/18.
+//
+
+#ifndef MappedFile_h
+#define MappedFile_h
+
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// read-only memory map of a whole file. the pages come straight from the page
+// cache, nothing is copied into the process until it is touched.
+class MappedFile
+{
+public:
+    MappedFile()
+    {
+    }
+    explicit MappedFile(const char* path)
+    {
+        open(path);
+    }
+    ~MappedFile()
+    {
+        close();
+    }
+    MappedFile(MappedFile&& other)
+        : mapping(other.mapping), length(other.length), opened(other.opened)
+    {
+        other.mapping = NULL;
+        other.length = 0;
+        other.opened = false;
+    }
+    MappedFile& operator=(MappedFile&& other)
+    {
+        if (this != &other)
+        {
+            close();
+            mapping = other.mapping;
+            length = other.length;
+            opened = other.opened;
+            other.mapping = NULL;
+            other.length = 0;
+            other.opened = false;
+        }
+        return *this;
+    }
+    // ------------------------------------------------------------------------
+    bool open(const char* path)
+    {
+        close();
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        length = (size_t)info.st_size;
+        // mmap refuses empty files, an empty file is still a valid file
+        if (length > 0)
+        {
+            void* address = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED)
+            {
+                ::close(fd);
+                length = 0;
+                return false;
+            }
+            mapping = address;
+        }
+        // the mapping keeps its own reference to the file
+        ::close(fd);
+        opened = true;
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void close()
+    {
+        if (mapping)
+            munmap(mapping, length);
+        mapping = NULL;
+        length = 0;
+        opened = false;
+    }
+    // ------------------------------------------------------------------------
+    bool isOpen() const
+    {
+        return opened;
+    }
+    const char* data() const
+    {
+        return mapping ? (const char*)mapping : "";
+    }
+    size_t size() const
+    {
+        return length;
+    }
+
+private:
+    void* mapping = NULL;
+    size_t length = 0;
+    bool opened = false;
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+#endif /* MappedFile_h */